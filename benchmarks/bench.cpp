@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../valiant/valiant.hpp"
+
+#ifndef VALIANT_BENCH_SPRITE
+#define VALIANT_BENCH_SPRITE "examples/assets/sprite.png"
+#endif
+
+// Headless frame timings of a few scenes, reported per phase as the median
+// and 99th percentile over every frame. Usage:
+//     bench [--frames N] [--count N] [--scene NAME] [--json]
+// Headless frames are rasterized on the CPU by SDL's software renderer and
+// present does nothing, so render and present are not the cost of a frame
+// drawn by a GPU. Use them to compare changes against each other only.
+
+const double FRAME_DELTA = 1. / 60;
+const size_t WARM_UP_FRAMES = 10;
+
+// Moves at a constant velocity and bounces off the edges of its area
+class Mover : public valiant::Object {
+   public:
+    valiant::Vector3 velocity;
+    float extent{0};
+
+    void update() override {
+        float seconds = static_cast<float>(time.delta_time);
+        transform.position.x += velocity.x * seconds;
+        transform.position.y += velocity.y * seconds;
+        if (std::fabs(transform.position.x) > extent) {
+            velocity.x = -velocity.x;
+        }
+        if (std::fabs(transform.position.y) > extent) {
+            velocity.y = -velocity.y;
+        }
+    }
+};
+
+class Box : public Mover, public valiant::Rectangle {};
+
+class Ball : public Mover,
+             public valiant::Rectangle,
+             public valiant::Collider {
+   public:
+    size_t contacts{0};
+
+    void on_collision_enter(const valiant::Collision &collision) override {
+        ++contacts;
+    }
+};
+
+class Picture : public Mover, public valiant::SpriteRenderer {};
+
+// Pans across the scene at a constant speed
+class PanningCamera : public valiant::Camera {
+   public:
+    void update() override {
+        transform.position.x += 120 * static_cast<float>(time.delta_time);
+    }
+};
+
+struct Scene {
+    std::string name;
+    std::string description;
+    // Objects are spread over [-extent, extent] on both axes, with shapes
+    // size wide and tall
+    // SCROLLING colliders are collided in screen space under a panning
+    // camera, every other one is static
+    enum class Kind { RECTANGLES, SPRITES, COLLIDERS, SCROLLING } kind;
+    float extent;
+    int size;
+};
+
+struct Percentiles {
+    double p50;
+    double p99;
+};
+
+// Nearest rank percentile, values are sorted in place
+static double percentile(std::vector<double> &values, double fraction) {
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(fraction * values.size()));
+    return values[std::max<size_t>(rank, 1) - 1];
+}
+
+static Percentiles get_percentiles(std::vector<double> values) {
+    // Reported in milliseconds
+    for (double &value : values) {
+        value *= 1000;
+    }
+    Percentiles percentiles;
+    percentiles.p50 = percentile(values, 0.5);
+    percentiles.p99 = percentile(values, 0.99);
+    return percentiles;
+}
+
+struct SceneResult {
+    const Scene *scene;
+    size_t count;
+    // update, collision, render, present, total
+    Percentiles phases[5];
+};
+
+const char *const PHASE_NAMES[] = {"update", "collision", "render",
+                                   "present", "total"};
+
+template <typename T>
+static void place(std::vector<T> &objects, const Scene &scene,
+                  valiant::Renderer &renderer) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> position(-scene.extent,
+                                                   scene.extent);
+    std::uniform_real_distribution<float> speed(-200, 200);
+    for (T &object : objects) {
+        object.transform.position = {position(generator), position(generator),
+                                     0};
+        object.velocity = {speed(generator), speed(generator), 0};
+        object.extent = scene.extent;
+        renderer.add_object(object);
+    }
+}
+
+template <typename T>
+static void shape(std::vector<T> &objects, const Scene &scene) {
+    for (T &object : objects) {
+        object.shape = valiant::Shape(scene.size, scene.size);
+    }
+}
+
+static SceneResult run_scene(const Scene &scene, size_t count, size_t frames) {
+    valiant::Renderer renderer(valiant::HEADLESS);
+    renderer.set_collision_space(valiant::CollisionSpace::WORLD);
+    PanningCamera camera;
+    std::vector<Box> boxes;
+    std::vector<Ball> balls;
+    std::vector<Picture> pictures;
+    switch (scene.kind) {
+        case Scene::Kind::RECTANGLES:
+            boxes.resize(count);
+            shape(boxes, scene);
+            place(boxes, scene, renderer);
+            break;
+        case Scene::Kind::COLLIDERS:
+            balls.resize(count);
+            shape(balls, scene);
+            place(balls, scene, renderer);
+            break;
+        case Scene::Kind::SCROLLING:
+            balls.resize(count);
+            shape(balls, scene);
+            for (size_t i = 0; i < balls.size(); i += 2) {
+                balls[i].collider.is_static = true;
+            }
+            place(balls, scene, renderer);
+            for (size_t i = 0; i < balls.size(); i += 2) {
+                balls[i].velocity = {0, 0, 0};
+            }
+            renderer.set_collision_space(valiant::CollisionSpace::SCREEN);
+            renderer.add_camera(camera);
+            break;
+        case Scene::Kind::SPRITES:
+            pictures.resize(count);
+            for (Picture &picture : pictures) {
+                picture.sprite_renderer.sprite = VALIANT_BENCH_SPRITE;
+            }
+            place(pictures, scene, renderer);
+            break;
+    }
+    renderer.run_frames(WARM_UP_FRAMES, FRAME_DELTA);
+    std::vector<double> timings[5];
+    for (size_t frame = 0; frame < frames; ++frame) {
+        renderer.run_frames(1, FRAME_DELTA);
+        valiant::FrameTimings frame_timings = renderer.frame_timings();
+        timings[0].push_back(frame_timings.update);
+        timings[1].push_back(frame_timings.collision);
+        timings[2].push_back(frame_timings.render);
+        timings[3].push_back(frame_timings.present);
+        timings[4].push_back(frame_timings.total());
+    }
+    SceneResult result;
+    result.scene = &scene;
+    result.count = count;
+    for (int phase = 0; phase < 5; ++phase) {
+        result.phases[phase] = get_percentiles(timings[phase]);
+    }
+    return result;
+}
+
+static void print_table(const std::vector<SceneResult> &results,
+                        size_t frames) {
+    std::printf("%zu frames of %.4f s after %zu warm up frames, in ms\n",
+                frames, FRAME_DELTA, WARM_UP_FRAMES);
+    std::printf("%-10s %8s %-10s %10s %10s\n", "scene", "objects", "phase",
+                "p50", "p99");
+    for (const SceneResult &result : results) {
+        for (int phase = 0; phase < 5; ++phase) {
+            std::printf("%-10s %8zu %-10s %10.3f %10.3f\n",
+                        result.scene->name.c_str(), result.count,
+                        PHASE_NAMES[phase], result.phases[phase].p50,
+                        result.phases[phase].p99);
+        }
+    }
+}
+
+static void print_json(const std::vector<SceneResult> &results,
+                       size_t frames) {
+    std::printf("{\n  \"frames\": %zu,\n  \"delta\": %.6f,\n", frames,
+                FRAME_DELTA);
+    std::printf("  \"unit\": \"ms\",\n  \"scenes\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SceneResult &result = results[i];
+        std::printf("    {\n      \"name\": \"%s\",\n",
+                    result.scene->name.c_str());
+        std::printf("      \"description\": \"%s\",\n",
+                    result.scene->description.c_str());
+        std::printf("      \"objects\": %zu,\n      \"phases\": {\n",
+                    result.count);
+        for (int phase = 0; phase < 5; ++phase) {
+            std::printf("        \"%s\": {\"p50\": %.6f, \"p99\": %.6f}%s\n",
+                        PHASE_NAMES[phase], result.phases[phase].p50,
+                        result.phases[phase].p99, phase < 4 ? "," : "");
+        }
+        std::printf("      }\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+
+int main(int argc, char *argv[]) {
+    const Scene scenes[] = {
+        {"rects", "moving rectangles, most of them off screen",
+         Scene::Kind::RECTANGLES, 5000, 16},
+        {"sprites", "moving sprites sharing one image, most off screen",
+         Scene::Kind::SPRITES, 5000, 0},
+        {"dense", "colliders packed so each touches several others",
+         Scene::Kind::COLLIDERS, 1000, 24},
+        {"sparse", "colliders spread out so few touch", Scene::Kind::COLLIDERS,
+         50000, 24},
+        {"scroll", "half static colliders in screen space, panning camera",
+         Scene::Kind::SCROLLING, 5000, 24},
+    };
+    size_t frames = 300;
+    size_t count = 10000;
+    std::string only_scene;
+    bool json = false;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && has_value) {
+            frames = std::max<unsigned long>(
+                std::strtoul(argv[++i], nullptr, 10), 1);
+        } else if (std::strcmp(argv[i], "--count") == 0 && has_value) {
+            count = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--scene") == 0 && has_value) {
+            only_scene = argv[++i];
+        } else {
+            std::fprintf(stderr,
+                         "Usage: %s [--frames N] [--count N] [--scene NAME] "
+                         "[--json]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+    std::vector<SceneResult> results;
+    for (const Scene &scene : scenes) {
+        if (only_scene.empty() || only_scene == scene.name) {
+            results.push_back(run_scene(scene, count, frames));
+        }
+    }
+    if (results.empty()) {
+        std::fprintf(stderr, "Unknown scene: %s\n", only_scene.c_str());
+        return 1;
+    }
+    if (json) {
+        print_json(results, frames);
+    } else {
+        print_table(results, frames);
+    }
+}
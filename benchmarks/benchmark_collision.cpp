@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../valiant/valiant.hpp"
+
+class Box : public valiant::Object,
+            public valiant::Rectangle,
+            public valiant::Collider {
+   public:
+    size_t contacts{0};
+
+    void on_collision_enter(const valiant::Collision &collision) override {
+        ++contacts;
+    }
+};
+
+// Objects are scattered over a square whose area grows with the object count
+// so the number of contacts per object stays roughly constant
+static std::vector<Box> make_scene(size_t count) {
+    std::vector<Box> boxes(count);
+    std::mt19937 generator(1);
+    float extent = std::sqrt(static_cast<float>(count)) * 60.0f;
+    std::uniform_real_distribution<float> position(-extent / 2, extent / 2);
+    for (Box &box : boxes) {
+        box.shape.width = 40;
+        box.shape.height = 40;
+        box.transform.position = {position(generator), position(generator), 0};
+    }
+    return boxes;
+}
+
+static std::vector<valiant::Object *> get_pointers(std::vector<Box> &boxes) {
+    std::vector<valiant::Object *> pointers;
+    for (Box &box : boxes) {
+        pointers.push_back(&box);
+    }
+    return pointers;
+}
+
+// Pair test as it was done before colliders were projected once per frame:
+// every pair casts and projects its second collider again
+static size_t legacy_pass(const std::vector<valiant::Object *> &objects,
+                          valiant::CameraData camera) {
+    size_t hits = 0;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        valiant::Collider *collider_1 =
+            dynamic_cast<valiant::Collider *>(objects[i]);
+        SDL_Rect rect_1 = valiant::ObjectManager::get_object_camera_position(
+            valiant::ObjectManager::get_object_data(objects[i]), camera);
+        for (size_t j = i + 1; j < objects.size(); ++j) {
+            valiant::Collider *collider_2 =
+                dynamic_cast<valiant::Collider *>(objects[j]);
+            SDL_Rect rect_2 =
+                valiant::ObjectManager::get_object_camera_position(
+                    valiant::ObjectManager::get_object_data(objects[j]),
+                    camera);
+            if (collider_1->collider.enabled && collider_2->collider.enabled &&
+                valiant::CollisionManager::is_colliding(rect_1, rect_2)) {
+                ++hits;
+            }
+        }
+    }
+    return hits;
+}
+
+template <typename F>
+static double time_milliseconds(F function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static double time_manager(std::vector<valiant::Object *> &objects,
+                           valiant::BroadPhase broad_phase,
+                           valiant::CameraData camera,
+                           size_t thread_count = 1) {
+    valiant::CollisionManager collision_manager;
+    collision_manager.set_broad_phase(broad_phase);
+    collision_manager.set_thread_count(thread_count);
+    collision_manager.fill_collider_objects(objects);
+    // First frame dispatches enter events, second frame is steady state
+    collision_manager.process_collisions(camera);
+    return time_milliseconds(
+        [&]() { collision_manager.process_collisions(camera); });
+}
+
+int main(int argc, char *argv[]) {
+    // Brute force passes are quadratic, so the slowest ones are opt-in
+    bool run_all = (argc > 1 && std::strcmp(argv[1], "--all") == 0);
+    valiant::CameraData camera = {1., {0, 0, 0}};
+    const size_t counts[] = {1000, 10000, 100000};
+    std::printf("%10s %14s %14s %14s\n", "colliders", "legacy (ms)",
+                "brute (ms)", "sweep (ms)");
+    for (size_t count : counts) {
+        std::vector<Box> boxes = make_scene(count);
+        std::vector<valiant::Object *> objects = get_pointers(boxes);
+        double legacy = -1;
+        double brute_force = -1;
+        if (run_all || count <= 10000) {
+            legacy = time_milliseconds(
+                [&]() { legacy_pass(objects, camera); });
+        }
+        if (run_all || count <= 10000) {
+            brute_force = time_manager(
+                objects, valiant::BroadPhase::BRUTE_FORCE, camera);
+        }
+        double sweep = time_manager(
+            objects, valiant::BroadPhase::SWEEP_AND_PRUNE, camera);
+        std::printf("%10zu %14.3f %14.3f %14.3f\n", count, legacy,
+                    brute_force, sweep);
+    }
+    std::printf("(-1 marks passes skipped without --all)\n\n");
+    // Same scenes with 90% of colliders on a bullet layer that only collides
+    // with the remaining players
+    std::printf("%10s %14s %14s\n", "bullets", "brute (ms)", "sweep (ms)");
+    for (size_t count : counts) {
+        std::vector<Box> boxes = make_scene(count);
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            if (i % 10 != 0) {
+                boxes[i].collider.layer = 1;
+                boxes[i].collider.layer_mask = 1;
+            }
+        }
+        std::vector<valiant::Object *> objects = get_pointers(boxes);
+        double brute_force = -1;
+        if (run_all || count <= 10000) {
+            brute_force = time_manager(
+                objects, valiant::BroadPhase::BRUTE_FORCE, camera);
+        }
+        double sweep = time_manager(
+            objects, valiant::BroadPhase::SWEEP_AND_PRUNE, camera);
+        std::printf("%10zu %14.3f %14.3f\n", count, brute_force, sweep);
+    }
+    std::printf("\n");
+    // Same scenes with 90% of colliders marked static
+    std::printf("%10s %14s %14s\n", "statics", "brute (ms)", "sweep (ms)");
+    for (size_t count : counts) {
+        std::vector<Box> boxes = make_scene(count);
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            boxes[i].collider.is_static = i % 10 != 0;
+        }
+        std::vector<valiant::Object *> objects = get_pointers(boxes);
+        double brute_force = -1;
+        if (run_all || count <= 10000) {
+            brute_force = time_manager(
+                objects, valiant::BroadPhase::BRUTE_FORCE, camera);
+        }
+        double sweep = time_manager(
+            objects, valiant::BroadPhase::SWEEP_AND_PRUNE, camera);
+        std::printf("%10zu %14.3f %14.3f\n", count, brute_force, sweep);
+    }
+    std::printf("\n");
+    // Thread scaling, callbacks are still dispatched on the main thread
+    size_t hardware_threads =
+        std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::printf("hardware threads: %zu\n", hardware_threads);
+    std::printf("%10s %20s %20s\n", "threads", "brute 10k (ms)",
+                "sweep 100k (ms)");
+    std::vector<Box> small_boxes = make_scene(10000);
+    std::vector<valiant::Object *> small_objects = get_pointers(small_boxes);
+    std::vector<Box> large_boxes = make_scene(100000);
+    std::vector<valiant::Object *> large_objects = get_pointers(large_boxes);
+    for (size_t thread_count = 1;
+         thread_count <= std::max<size_t>(hardware_threads, 4);
+         thread_count *= 2) {
+        double brute_force =
+            time_manager(small_objects, valiant::BroadPhase::BRUTE_FORCE,
+                         camera, thread_count);
+        double sweep =
+            time_manager(large_objects, valiant::BroadPhase::SWEEP_AND_PRUNE,
+                         camera, thread_count);
+        std::printf("%10zu %20.3f %20.3f\n", thread_count, brute_force,
+                    sweep);
+    }
+}
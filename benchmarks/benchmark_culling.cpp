@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../valiant/valiant.hpp"
+
+// Static map tile, placed in the culling grid once
+class Tile : public valiant::Object,
+             public valiant::Rectangle,
+             public valiant::Collider {
+   public:
+    Tile() {
+        shape = valiant::Shape(32, 32);
+        collider.is_static = true;
+        collider.enabled = false;
+    }
+};
+
+class Mover : public valiant::Object, public valiant::Rectangle {
+   public:
+    Mover() { shape = valiant::Shape(16, 16); }
+
+    void update() override { transform.position.x += 1; }
+};
+
+// Average milliseconds per frame for a map ten windows wide and ten windows
+// tall, so about 1% of it is on screen
+static double time_frames(size_t count, bool culling) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> x(-9600, 9600);
+    std::uniform_real_distribution<float> y(-5400, 5400);
+    std::vector<Tile> tiles(count - count / 10);
+    std::vector<Mover> movers(count / 10);
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_culling(culling);
+    for (Tile &tile : tiles) {
+        tile.transform.position = {x(generator), y(generator), 0};
+        renderer.add_object(tile);
+    }
+    for (Mover &mover : movers) {
+        mover.transform.position = {x(generator), y(generator), 0};
+        renderer.add_object(mover);
+    }
+    renderer.run();
+    renderer.step(1. / 60);
+    const int frames = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        renderer.step(1. / 60);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() /
+           frames;
+}
+
+int main() {
+    // Without a window draw calls fail early, so this mostly measures the
+    // cost of visiting objects rather than the draw calls saved
+    const size_t counts[] = {10000, 100000};
+    std::printf("%10s %16s %16s\n", "objects", "no culling (ms)",
+                "culling (ms)");
+    for (size_t count : counts) {
+        std::printf("%10zu %16.3f %16.3f\n", count, time_frames(count, false),
+                    time_frames(count, true));
+    }
+}
@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "../valiant/valiant.hpp"
+
+class Box : public valiant::Object, public valiant::Rectangle {};
+
+class Wall : public valiant::Object,
+             public valiant::Rectangle,
+             public valiant::Collider {};
+
+class Marker : public valiant::Object {};
+
+template <typename F>
+static double time_milliseconds(F function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Per object work done by a frame, as it was done before components were
+// resolved on registration
+static long long legacy_frame(const std::vector<valiant::Object *> &objects,
+                              valiant::CameraData camera) {
+    long long checksum = 0;
+    for (valiant::Object *object : objects) {
+        if (dynamic_cast<valiant::SpriteRenderer *>(object) ||
+            dynamic_cast<valiant::Rectangle *>(object)) {
+            SDL_Rect rect = valiant::ObjectManager::get_object_camera_position(
+                valiant::ObjectManager::get_object_data(object), camera);
+            checksum += rect.x;
+        }
+        if (dynamic_cast<valiant::Collider *>(object)) {
+            SDL_Rect rect = valiant::ObjectManager::get_object_camera_position(
+                valiant::ObjectManager::get_object_data(object), camera);
+            checksum += rect.y;
+        }
+    }
+    return checksum;
+}
+
+static long long resolved_frame(
+    const std::vector<valiant::ObjectComponents> &objects,
+    valiant::CameraData camera) {
+    long long checksum = 0;
+    for (const valiant::ObjectComponents &components : objects) {
+        if (components.sprite_renderer || components.rectangle) {
+            SDL_Rect rect = valiant::ObjectManager::get_object_camera_position(
+                valiant::ObjectManager::get_object_data(components), camera);
+            checksum += rect.x;
+        }
+        if (components.collider) {
+            SDL_Rect rect = valiant::ObjectManager::get_object_camera_position(
+                valiant::ObjectManager::get_object_data(components), camera);
+            checksum += rect.y;
+        }
+    }
+    return checksum;
+}
+
+int main() {
+    const size_t count = 100000;
+    const int frames = 20;
+    std::vector<Box> boxes(count / 2);
+    std::vector<Wall> walls(count / 4);
+    std::vector<Marker> markers(count / 4);
+    std::vector<valiant::Object *> objects;
+    std::vector<valiant::ObjectComponents> components;
+    // Interleave kinds as a scene would
+    for (size_t i = 0; i < count / 4; ++i) {
+        objects.push_back(&boxes[2 * i]);
+        components.push_back(valiant::get_object_components(boxes[2 * i]));
+        objects.push_back(&walls[i]);
+        components.push_back(valiant::get_object_components(walls[i]));
+        objects.push_back(&boxes[2 * i + 1]);
+        components.push_back(
+            valiant::get_object_components(boxes[2 * i + 1]));
+        objects.push_back(&markers[i]);
+        components.push_back(valiant::get_object_components(markers[i]));
+    }
+    valiant::CameraData camera = {1., {0, 0, 0}};
+    long long legacy_checksum = 0;
+    long long resolved_checksum = 0;
+    double legacy = time_milliseconds([&]() {
+        for (int frame = 0; frame < frames; ++frame) {
+            legacy_checksum += legacy_frame(objects, camera);
+        }
+    });
+    double resolved = time_milliseconds([&]() {
+        for (int frame = 0; frame < frames; ++frame) {
+            resolved_checksum += resolved_frame(components, camera);
+        }
+    });
+    std::printf("%zu objects, ms per frame\n", count);
+    std::printf("%12s %12s\n", "dynamic_cast", "resolved");
+    std::printf("%12.3f %12.3f\n", legacy / frames, resolved / frames);
+    return legacy_checksum == resolved_checksum ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../valiant/valiant.hpp"
+
+class Mover : public valiant::Object {
+   public:
+    valiant::Velocity velocity;
+
+    void update() override {
+        float seconds = static_cast<float>(time.delta_time);
+        transform.position.x += velocity.x * seconds;
+        transform.position.y += velocity.y * seconds;
+    }
+};
+
+const int FRAMES = 20;
+
+template <typename F>
+static double time_frames(F frame) {
+    // One warm up frame
+    frame();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; ++i) {
+        frame();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() /
+           FRAMES;
+}
+
+// Average milliseconds per frame for count movers updated as objects, each
+// allocated on its own like game code does
+static double time_objects(size_t count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> speed(-100, 100);
+    std::vector<std::unique_ptr<Mover>> movers;
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_culling(false);
+    for (size_t i = 0; i < count; ++i) {
+        movers.emplace_back(new Mover());
+        movers.back()->velocity = {speed(generator), speed(generator)};
+        renderer.add_object(*movers.back());
+    }
+    renderer.run();
+    return time_frames([&renderer]() { renderer.step(1. / 60); });
+}
+
+// Average milliseconds per frame for count movers updated as entities
+static double time_entities(size_t count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> speed(-100, 100);
+    valiant::Registry registry;
+    for (size_t i = 0; i < count; ++i) {
+        valiant::Entity entity = registry.create();
+        registry.add<valiant::Transform>(entity);
+        registry.add<valiant::Velocity>(
+            entity, valiant::Velocity(speed(generator), speed(generator)));
+    }
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_registry(registry);
+    renderer.add_system(valiant::update_movement);
+    renderer.run();
+    return time_frames([&renderer]() { renderer.step(1. / 60); });
+}
+
+// Average milliseconds per frame for the collision system over count
+// entities spread so that each overlaps a few others
+static double time_entity_collisions(size_t count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> position(-50000, 50000);
+    valiant::Registry registry;
+    for (size_t i = 0; i < count; ++i) {
+        valiant::Entity entity = registry.create();
+        registry.add<valiant::Transform>(entity).position = {
+            position(generator), position(generator), 0};
+        registry.add<valiant::Shape>(entity, valiant::Shape(100, 100));
+        registry.add<valiant::ColliderComponent>(entity);
+    }
+    valiant::CollisionSystem collision_system;
+    size_t collisions = 0;
+    double milliseconds = time_frames([&]() {
+        collisions = collision_system.update(registry).size();
+    });
+    std::printf("%zu entities, %zu overlapping pairs\n", count, collisions);
+    return milliseconds;
+}
+
+int main() {
+    const size_t counts[] = {100000, 1000000};
+    std::printf("%10s %16s %16s\n", "movers", "objects (ms)", "entities (ms)");
+    for (size_t count : counts) {
+        std::printf("%10zu %16.3f %16.3f\n", count, time_objects(count),
+                    time_entities(count));
+    }
+    double milliseconds = time_entity_collisions(100000);
+    std::printf("collision system: %.3f ms\n", milliseconds);
+}
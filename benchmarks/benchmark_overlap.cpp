@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../valiant/overlap.hpp"
+
+template <typename F>
+static double time_nanoseconds(F function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+int main() {
+    const size_t box_count = 1 << 16;
+    const size_t query_count = 1 << 12;
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<float> position(0, 1000);
+    valiant::ColliderBuffer buffer;
+    buffer.resize(box_count);
+    for (size_t i = 0; i < box_count; ++i) {
+        float x = position(generator);
+        float y = position(generator);
+        valiant::AABB aabb = {x, y, x + 20, y + 20};
+        buffer.set(i, aabb, true);
+    }
+    std::vector<valiant::AABB> queries;
+    for (size_t i = 0; i < query_count; ++i) {
+        queries.push_back(buffer.get(i));
+    }
+    const size_t block_sizes[] = {4, 8, 16, 32};
+    std::printf("%6s %16s %16s %10s\n", "block", "scalar (ns/box)",
+                "kernel (ns/box)", "speedup");
+    for (size_t block_size : block_sizes) {
+        // Accumulate hit counts so the passes can not be optimized away
+        uint64_t scalar_hits = 0;
+        uint64_t kernel_hits = 0;
+        double scalar = time_nanoseconds([&]() {
+            for (const valiant::AABB &box : queries) {
+                for (size_t start = 0; start < box_count;
+                     start += block_size) {
+                    uint32_t mask = valiant::OverlapKernel::mask_scalar(
+                        box, &buffer.min_x[start], &buffer.min_y[start],
+                        &buffer.max_x[start], &buffer.max_y[start],
+                        block_size);
+                    scalar_hits += static_cast<uint64_t>(mask != 0);
+                }
+            }
+        });
+        double kernel = time_nanoseconds([&]() {
+            for (const valiant::AABB &box : queries) {
+                for (size_t start = 0; start < box_count;
+                     start += block_size) {
+                    uint32_t mask =
+                        buffer.overlap_mask(box, start, block_size);
+                    kernel_hits += static_cast<uint64_t>(mask != 0);
+                }
+            }
+        });
+        double tests = static_cast<double>(box_count) * query_count;
+        std::printf("%6zu %16.3f %16.3f %9.2fx%s\n", block_size,
+                    scalar / tests, kernel / tests, scalar / kernel,
+                    scalar_hits == kernel_hits ? "" : " MISMATCH");
+    }
+}
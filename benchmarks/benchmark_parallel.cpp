@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../valiant/valiant.hpp"
+
+// Steers towards a target it circles around, enough work per update for
+// the split across threads to matter
+class Mover : public valiant::Object {
+   public:
+    valiant::Vector3 target;
+
+    void update() override {
+        float seconds = static_cast<float>(time.delta_time);
+        float dx = target.x - transform.position.x;
+        float dy = target.y - transform.position.y;
+        float distance = std::sqrt(dx * dx + dy * dy) + 1;
+        float angle = std::atan2(dy, dx) + 0.5f;
+        transform.position.x += std::cos(angle) * distance * seconds;
+        transform.position.y += std::sin(angle) * distance * seconds;
+    }
+};
+
+class ParallelMover : public Mover, public valiant::ParallelUpdate {};
+
+// Average milliseconds per frame for count independent movers
+template <typename T>
+static double time_frames(size_t count, size_t thread_count) {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> position(-5000, 5000);
+    std::vector<T> movers(count);
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_culling(false);
+    renderer.set_update_thread_count(thread_count);
+    for (T &mover : movers) {
+        mover.transform.position = {position(generator), position(generator),
+                                    0};
+        mover.target = {position(generator), position(generator), 0};
+        renderer.add_object(mover);
+    }
+    renderer.run();
+    renderer.step(1. / 60);
+    const int frames = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        renderer.step(1. / 60);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() /
+           frames;
+}
+
+int main() {
+    const size_t count = 200000;
+    size_t hardware_threads = valiant::JobSystem::hardware_thread_count();
+    std::printf("%zu movers, %zu hardware threads\n", count,
+                hardware_threads);
+    std::printf("%10s %16s\n", "threads", "frame (ms)");
+    std::printf("%10s %16.3f\n", "serial", time_frames<Mover>(count, 1));
+    const size_t thread_counts[] = {1, 2, 4, hardware_threads};
+    for (size_t thread_count : thread_counts) {
+        std::printf("%10zu %16.3f\n", thread_count,
+                    time_frames<ParallelMover>(count, thread_count));
+    }
+}
@@ -10,12 +10,11 @@ class Paddle : public valiant::Object,
    public:
     bool up{false};
     bool down{false};
-    Paddle(int x, const std::string &paddle_tag, const std::string &up_key,
-           const std::string &down_key)
+    Paddle(int x, const std::string &paddle_tag)
         : move_speed_(1000),
           tag_(paddle_tag),
-          up_key_(up_key),
-          down_key_(down_key) {
+          up_action_(input.action(paddle_tag + "_up")),
+          down_action_(input.action(paddle_tag + "_down")) {
         transform.position.x = x;
     }
 
@@ -27,17 +26,17 @@ class Paddle : public valiant::Object,
     }
 
     void update() override {
-        if (input.get_key(up_key_)) {
+        if (input.get_action(up_action_)) {
             up = true;
         }
-        if (input.get_key(down_key_)) {
+        if (input.get_action(down_action_)) {
             down = true;
         }
 
-        if (input.get_key_up(up_key_)) {
+        if (input.get_action_up(up_action_)) {
             up = false;
         }
-        if (input.get_key_up(down_key_)) {
+        if (input.get_action_up(down_action_)) {
             down = false;
         }
 
@@ -46,9 +45,9 @@ class Paddle : public valiant::Object,
 
    private:
     const float move_speed_;
-    std::string tag_;
-    std::string up_key_;
-    std::string down_key_;
+    valiant::Tag tag_;
+    valiant::Action up_action_;
+    valiant::Action down_action_;
 
     void move() {
         float delta = move_speed_ * time.delta_time;
@@ -90,13 +89,14 @@ class Ball : public valiant::Object,
     }
 
     void on_collision_enter(const valiant::Collision &collision) override {
-        if (collision.tag == "paddle_1" || collision.tag == "paddle_2") {
+        // Tags compare as integers
+        if (collision.tag == paddle_1_.tag || collision.tag == paddle_2_.tag) {
+            const Paddle &paddle =
+                collision.tag == paddle_1_.tag ? paddle_1_ : paddle_2_;
             velocity_x_ = -1 * velocity_x_;
-            if ((collision.tag == "paddle_1" && paddle_1_.up) ||
-                (collision.tag == "paddle_2" && paddle_2_.up)) {
+            if (paddle.up) {
                 velocity_y_ -= speed_;
-            } else if ((collision.tag == "paddle_1" && paddle_1_.down) ||
-                       (collision.tag == "paddle_2" && paddle_2_.down)) {
+            } else if (paddle.down) {
                 velocity_y_ += speed_;
             }
         }
@@ -151,8 +151,13 @@ class Ball : public valiant::Object,
 int main() {
     std::srand(std::time(0));
     valiant::Renderer renderer(valiant::ENABLE | valiant::VSYNC);
-    Paddle paddle_1(-750, "paddle_1", "W", "S");
-    Paddle paddle_2(750, "paddle_2", "Up", "Down");
+    // Keys are resolved once, paddles only refer to actions
+    valiant::Input::bind("paddle_1_up", valiant::Input::key("W"));
+    valiant::Input::bind("paddle_1_down", valiant::Input::key("S"));
+    valiant::Input::bind("paddle_2_up", valiant::Input::key("Up"));
+    valiant::Input::bind("paddle_2_down", valiant::Input::key("Down"));
+    Paddle paddle_1(-750, "paddle_1");
+    Paddle paddle_2(750, "paddle_2");
     Ball ball(paddle_1, paddle_2);
     renderer.add_object(paddle_1);
     renderer.add_object(paddle_2);
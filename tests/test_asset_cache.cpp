@@ -0,0 +1,205 @@
+#include <catch2/catch.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../valiant/asset_cache.hpp"
+#include "../valiant/sprite_renderer.hpp"
+
+TEST_CASE("Asset cache shares images by path") {
+    std::string sprite_path = "examples/assets/sprite.png";
+    valiant::AssetCache &asset_cache = valiant::AssetCache::instance();
+    valiant::AssetCacheStats before = asset_cache.stats();
+    {
+        valiant::Sprite sprite_1;
+        valiant::Sprite sprite_2;
+        sprite_1 = sprite_path;
+        sprite_2 = sprite_path;
+        // Decoded once, shared by both sprites
+        REQUIRE(sprite_1.image == sprite_2.image);
+        REQUIRE(sprite_2.width == sprite_1.image->width);
+        valiant::AssetCacheStats stats = asset_cache.stats();
+        REQUIRE(stats.misses == before.misses + 1);
+        REQUIRE(stats.hits == before.hits + 1);
+        REQUIRE(stats.images == before.images + 1);
+        REQUIRE(stats.bytes_resident ==
+                before.bytes_resident + sprite_1.image->bytes());
+        // Copies share the image too
+        valiant::Sprite sprite_3 = sprite_1;
+        REQUIRE(sprite_3.image == sprite_1.image);
+    }
+    // Evicted with its last sprite
+    valiant::AssetCacheStats after = asset_cache.stats();
+    REQUIRE(after.images == before.images);
+    REQUIRE(after.bytes_resident == before.bytes_resident);
+    valiant::Sprite sprite;
+    sprite = sprite_path;
+    REQUIRE(asset_cache.stats().misses == before.misses + 2);
+}
+
+TEST_CASE("Asset cache failed loads") {
+    valiant::AssetCache &asset_cache = valiant::AssetCache::instance();
+    valiant::AssetCacheStats before = asset_cache.stats();
+    valiant::Sprite sprite;
+    REQUIRE_THROWS_AS(sprite = "missing sprite path", valiant::ValiantError);
+    REQUIRE(sprite.image == nullptr);
+    // Failed loads are not cached
+    REQUIRE_THROWS_AS(sprite = "missing sprite path", valiant::ValiantError);
+    REQUIRE(asset_cache.stats().misses == before.misses + 2);
+    REQUIRE(asset_cache.stats().images == before.images);
+}
+
+TEST_CASE("Asset cache upload") {
+    valiant::AssetCache &asset_cache = valiant::AssetCache::instance();
+    valiant::Sprite sprite;
+    sprite = "examples/assets/sprite.png";
+    valiant::Image &image = *sprite.image;
+    // Creating a texture needs a renderer, the surface is kept until then
+    asset_cache.upload(image, nullptr, false);
+    REQUIRE(image.is_uploaded() == false);
+    REQUIRE(image.surface != nullptr);
+    // Packing into the atlas does not
+    asset_cache.upload(image, nullptr, true);
+    REQUIRE(image.atlas_page >= 0);
+    REQUIRE(image.surface == nullptr);
+    // Released images are decoded again when uploaded next
+    asset_cache.release_textures();
+    REQUIRE(image.is_uploaded() == false);
+    asset_cache.upload(image, nullptr, true);
+    REQUIRE(image.atlas_page >= 0);
+}
+
+void wait_for_loads(valiant::AssetCache &asset_cache) {
+    for (int i = 0; i < 1000 && asset_cache.pending_loads() > 0; ++i) {
+        SDL_Delay(1);
+    }
+}
+
+TEST_CASE("Asset cache background loads") {
+    valiant::AssetCache &asset_cache = valiant::AssetCache::instance();
+    valiant::AssetCacheStats before = asset_cache.stats();
+    valiant::Sprite sprite_1;
+    valiant::Sprite sprite_2;
+    sprite_1.load_async("examples/assets/sprite.png", 8, 4);
+    sprite_2.load_async("./examples/assets/sprite.png");
+    // Placeholder size until the image is decoded
+    REQUIRE(sprite_1.image->loading);
+    REQUIRE(sprite_1.width == 8);
+    REQUIRE(sprite_1.height == 4);
+    REQUIRE(sprite_1.ready == false);
+    wait_for_loads(asset_cache);
+    REQUIRE(asset_cache.pending_loads() == 0);
+    REQUIRE(asset_cache.pending_uploads() == 2);
+    // Uploads are bounded per call
+    REQUIRE(asset_cache.process_uploads(nullptr, true, 1) == 1);
+    REQUIRE(asset_cache.pending_uploads() == 1);
+    REQUIRE(asset_cache.process_uploads(nullptr, true, 1) == 1);
+    REQUIRE(asset_cache.pending_uploads() == 0);
+    REQUIRE(sprite_1.image->is_uploaded());
+    REQUIRE(sprite_2.image->is_uploaded());
+    REQUIRE(sprite_1.image->width > 0);
+    valiant::AssetCacheStats stats = asset_cache.stats();
+    REQUIRE(stats.misses == before.misses + 2);
+    REQUIRE(stats.bytes_resident ==
+            before.bytes_resident + sprite_1.image->bytes() +
+                sprite_2.image->bytes());
+    // Loaded images are shared without waiting
+    valiant::Sprite sprite_3;
+    sprite_3.load_async("examples/assets/sprite.png", 8, 4);
+    REQUIRE(sprite_3.image == sprite_1.image);
+    REQUIRE(sprite_3.width == sprite_1.image->width);
+}
+
+TEST_CASE("Asset cache failed background loads") {
+    valiant::AssetCache &asset_cache = valiant::AssetCache::instance();
+    valiant::Sprite sprite;
+    sprite.load_async("missing sprite path");
+    wait_for_loads(asset_cache);
+    asset_cache.process_uploads(nullptr, true, 1);
+    // Errors are kept on the image instead of thrown on the loader thread
+    REQUIRE(sprite.image->loading == false);
+    REQUIRE(sprite.image->error.empty() == false);
+    asset_cache.upload(*sprite.image, nullptr, true);
+    REQUIRE(sprite.image->is_uploaded() == false);
+}
+
+TEST_CASE("Asset cache synchronous loads finish background loads") {
+    valiant::AssetCache &asset_cache = valiant::AssetCache::instance();
+    valiant::Sprite sprite_1;
+    valiant::Sprite sprite_2;
+    sprite_1.load_async("examples/assets/sprite.png");
+    sprite_2 = "examples/assets/sprite.png";
+    REQUIRE(sprite_1.image == sprite_2.image);
+    REQUIRE(sprite_2.image->loading == false);
+    REQUIRE(sprite_2.width > 0);
+    // The background result is discarded
+    wait_for_loads(asset_cache);
+    REQUIRE(asset_cache.process_uploads(nullptr, true, 8) == 0);
+}
+
+TEST_CASE("Asset cache background uploads copy only their regions") {
+    valiant::AssetCache &asset_cache = valiant::AssetCache::instance();
+    valiant::TextureAtlas &atlas = asset_cache.atlas();
+    SDL_Surface *target =
+        SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer *renderer = SDL_CreateSoftwareRenderer(target);
+    valiant::Sprite first;
+    first = "examples/assets/sprite.png";
+    asset_cache.upload(*first.image, renderer, true);
+    for (size_t page = 0; page < atlas.page_count(); ++page) {
+        REQUIRE(atlas.texture(static_cast<int>(page), renderer) != nullptr);
+    }
+    // Distinct paths to the same file are distinct images
+    const char *paths[] = {"./examples/assets/sprite.png",
+                           "././examples/assets/sprite.png",
+                           "./././examples/assets/sprite.png",
+                           "././././examples/assets/sprite.png"};
+    std::vector<valiant::Sprite> sprites(4);
+    for (size_t i = 0; i < sprites.size(); ++i) {
+        sprites[i].load_async(paths[i]);
+    }
+    wait_for_loads(asset_cache);
+    valiant::AtlasStats before = atlas.stats();
+    size_t page_count = atlas.page_count();
+    // Every frame uploads at most the budget, each into its own region of
+    // the page texture the atlas batches already use
+    for (int frame = 1; frame <= 2; ++frame) {
+        REQUIRE(asset_cache.process_uploads(renderer, true, 2) == 2);
+        for (size_t page = 0; page < atlas.page_count(); ++page) {
+            atlas.texture(static_cast<int>(page), renderer);
+        }
+        valiant::AtlasStats stats = atlas.stats();
+        REQUIRE(stats.region_uploads == before.region_uploads + 2 * frame);
+        REQUIRE(stats.textures_created == before.textures_created);
+    }
+    REQUIRE(atlas.page_count() == page_count);
+    asset_cache.release_textures();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+}
+
+TEST_CASE("Asset cache reclaims atlas pages of evicted images") {
+    valiant::AssetCache &asset_cache = valiant::AssetCache::instance();
+    valiant::TextureAtlas &atlas = asset_cache.atlas();
+    asset_cache.release_textures();
+    size_t pages_reset = atlas.stats().pages_reset;
+    std::unique_ptr<valiant::Sprite> kept(new valiant::Sprite());
+    *kept = "examples/assets/sprite.png";
+    asset_cache.upload(*kept->image, nullptr, true);
+    {
+        valiant::Sprite dropped;
+        dropped = "./examples/assets/sprite.png";
+        asset_cache.upload(*dropped.image, nullptr, true);
+        REQUIRE(dropped.image->atlas_page == kept->image->atlas_page);
+    }
+    // Still used by the kept image
+    REQUIRE(atlas.stats().pages_reset == pages_reset);
+    kept.reset();
+    REQUIRE(atlas.stats().pages_reset == pages_reset + 1);
+    // Packed again from the top of the page
+    valiant::Sprite sprite;
+    sprite = "examples/assets/sprite.png";
+    asset_cache.upload(*sprite.image, nullptr, true);
+    REQUIRE(sprite.image->atlas_rect.x == valiant::TEXTURE_ATLAS_PADDING);
+    REQUIRE(sprite.image->atlas_rect.y == valiant::TEXTURE_ATLAS_PADDING);
+}
@@ -0,0 +1,153 @@
+#include <SDL2/SDL.h>
+
+#include <catch2/catch.hpp>
+
+#include "../valiant/input.hpp"
+#include "../valiant/renderer.hpp"
+
+static SDL_Event make_key_event(uint32_t type, SDL_Scancode scancode,
+                                uint8_t repeat = 0) {
+    SDL_Event event{};
+    event.type = type;
+    event.key.repeat = repeat;
+    event.key.keysym.scancode = scancode;
+    return event;
+}
+
+TEST_CASE("Keyboard state transitions") {
+    valiant::KeyboardState &keyboard = valiant::KeyboardState::instance();
+    keyboard.reset();
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_W));
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_A));
+    // Keys pressed together are both seen
+    REQUIRE(keyboard.pressed(SDL_SCANCODE_W));
+    REQUIRE(keyboard.pressed(SDL_SCANCODE_A));
+    REQUIRE(keyboard.held(SDL_SCANCODE_W));
+    keyboard.clear_transitions();
+    // Repeats do not count as presses
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_W, 1));
+    REQUIRE(keyboard.pressed(SDL_SCANCODE_W) == false);
+    REQUIRE(keyboard.held(SDL_SCANCODE_W));
+    keyboard.process(make_key_event(SDL_KEYUP, SDL_SCANCODE_W));
+    REQUIRE(keyboard.released(SDL_SCANCODE_W));
+    REQUIRE(keyboard.held(SDL_SCANCODE_W) == false);
+    REQUIRE(keyboard.held(SDL_SCANCODE_A));
+    keyboard.clear_transitions();
+    // A tap within one frame is still seen
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_S));
+    keyboard.process(make_key_event(SDL_KEYUP, SDL_SCANCODE_S));
+    REQUIRE(keyboard.pressed(SDL_SCANCODE_S));
+    REQUIRE(keyboard.held(SDL_SCANCODE_S));
+    REQUIRE(keyboard.released(SDL_SCANCODE_S));
+    keyboard.reset();
+    REQUIRE(keyboard.held(SDL_SCANCODE_A) == false);
+}
+
+TEST_CASE("Input key names") {
+    valiant::KeyboardState &keyboard = valiant::KeyboardState::instance();
+    keyboard.reset();
+    valiant::Input input;
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_UP));
+    REQUIRE(input.get_key_down("Up"));
+    REQUIRE(input.get_key("Up"));
+    REQUIRE(input.get_key_up("Up") == false);
+    REQUIRE(input.get_key("W") == false);
+    REQUIRE_THROWS_AS(input.get_key("not a key"), valiant::ValiantError);
+    keyboard.reset();
+}
+
+TEST_CASE("Input key handles") {
+    valiant::KeyboardState &keyboard = valiant::KeyboardState::instance();
+    keyboard.reset();
+    valiant::Input input;
+    valiant::Key up = valiant::Input::key("Up");
+    REQUIRE(up == valiant::Key(SDL_SCANCODE_UP));
+    REQUIRE_THROWS_AS(valiant::Input::key("not a key"),
+                      valiant::ValiantError);
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_UP));
+    REQUIRE(input.get_key_down(up));
+    REQUIRE(input.get_key(SDL_SCANCODE_UP));
+    REQUIRE(input.get_key_up(up) == false);
+    keyboard.reset();
+}
+
+TEST_CASE("Input actions") {
+    valiant::KeyboardState &keyboard = valiant::KeyboardState::instance();
+    keyboard.reset();
+    valiant::Input input;
+    valiant::Action jump = valiant::Input::action("test_jump");
+    REQUIRE(valiant::Input::action("test_jump").index == jump.index);
+    // Unbound actions are never triggered
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_SPACE));
+    REQUIRE(input.get_action(jump) == false);
+    keyboard.reset();
+    valiant::Input::bind("test_jump", valiant::Input::key("Space"));
+    valiant::Input::bind("test_jump", SDL_SCANCODE_W);
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_SPACE));
+    REQUIRE(input.get_action_down(jump));
+    REQUIRE(input.get_action(jump));
+    keyboard.clear_transitions();
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_W));
+    keyboard.process(make_key_event(SDL_KEYUP, SDL_SCANCODE_SPACE));
+    // Still held through the other key
+    REQUIRE(input.get_action(jump));
+    REQUIRE(input.get_action_up(jump) == false);
+    keyboard.clear_transitions();
+    keyboard.process(make_key_event(SDL_KEYUP, SDL_SCANCODE_W));
+    REQUIRE(input.get_action_up(jump));
+    REQUIRE(input.get_action(jump) == false);
+    valiant::ActionMap::instance().unbind("test_jump");
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_W));
+    REQUIRE(input.get_action(jump) == false);
+    keyboard.reset();
+}
+
+TEST_CASE("Renderer drains queued events before a frame") {
+    class Player : public valiant::Object {
+       public:
+        int both_pressed{0};
+        int pressed{0};
+
+        void update() override {
+            if (input.get_key_down("W") && input.get_key_down("D")) {
+                ++both_pressed;
+            }
+            if (input.get_key_down("W")) {
+                ++pressed;
+            }
+        }
+    };
+    valiant::KeyboardState::instance().reset();
+    valiant::Renderer renderer(valiant::DISABLE);
+    Player player;
+    renderer.add_object(player);
+    renderer.run();
+    SDL_Event event_1 = make_key_event(SDL_KEYDOWN, SDL_SCANCODE_W);
+    SDL_Event event_2 = make_key_event(SDL_KEYDOWN, SDL_SCANCODE_D);
+    SDL_PushEvent(&event_1);
+    SDL_PushEvent(&event_2);
+    REQUIRE(renderer.poll_events());
+    renderer.step(1. / 60);
+    // Presses are only seen by one update
+    renderer.poll_events();
+    renderer.step(1. / 60);
+    REQUIRE(player.both_pressed == 1);
+    REQUIRE(player.pressed == 1);
+    REQUIRE(player.input.get_key("W"));
+    valiant::KeyboardState::instance().reset();
+}
+
+TEST_CASE("Input keys by name without video") {
+    // No renderer exists, so the video subsystem is not initialized
+    REQUIRE(SDL_WasInit(SDL_INIT_VIDEO) == 0);
+    valiant::KeyboardState &keyboard = valiant::KeyboardState::instance();
+    keyboard.reset();
+    valiant::Input input;
+    REQUIRE(valiant::Input::key("Space") == valiant::Key(SDL_SCANCODE_SPACE));
+    valiant::Input::bind("test_fire", valiant::Input::key("W"));
+    keyboard.process(make_key_event(SDL_KEYDOWN, SDL_SCANCODE_W));
+    REQUIRE(input.get_key("W"));
+    REQUIRE(input.get_action(valiant::Input::action("test_fire")));
+    valiant::ActionMap::instance().unbind("test_fire");
+    keyboard.reset();
+}
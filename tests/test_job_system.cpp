@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "../valiant/job_system.hpp"
+
+TEST_CASE("Job system thread count") {
+    valiant::JobSystem single(1);
+    valiant::JobSystem quad(4);
+    valiant::JobSystem automatic;
+    REQUIRE(single.thread_count() == 1);
+    REQUIRE(quad.thread_count() == 4);
+    REQUIRE(automatic.thread_count() >= 1);
+}
+
+TEST_CASE("Job system parallel for") {
+    valiant::JobSystem job_system(4);
+    const size_t count = 10000;
+    std::vector<int> visits(count, 0);
+    // Assertions are not thread safe, so record results per worker
+    std::vector<size_t> largest_chunk(job_system.thread_count(), 0);
+    // Run several times to exercise reuse of the worker threads
+    for (int run = 0; run < 20; ++run) {
+        job_system.parallel_for(
+            count, 64, [&](size_t begin, size_t end, size_t worker) {
+                largest_chunk[worker] =
+                    std::max(largest_chunk[worker], end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    ++visits[i];
+                }
+            });
+    }
+    for (size_t chunk : largest_chunk) {
+        REQUIRE(chunk <= 64);
+    }
+    // Every index is visited exactly once per run
+    size_t wrong_visits = 0;
+    for (int visit_count : visits) {
+        if (visit_count != 20) {
+            ++wrong_visits;
+        }
+    }
+    REQUIRE(wrong_visits == 0);
+    SECTION("Empty range") {
+        bool called = false;
+        job_system.parallel_for(0, 1,
+                                [&](size_t, size_t, size_t) { called = true; });
+        REQUIRE(called == false);
+    }
+}
+
+TEST_CASE("Job system uneven work") {
+    valiant::JobSystem job_system(4);
+    // More threads than chunks, and counts that do not divide into chunks
+    const size_t counts[] = {3, 1000, 4097};
+    for (size_t count : counts) {
+        std::vector<int> visits(count, 0);
+        job_system.parallel_for(
+            count, 16, [&](size_t begin, size_t end, size_t) {
+                // Work dealt to the first worker is slow, so the other
+                // workers steal it
+                volatile size_t spin = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    for (size_t j = 0; j < (i < count / 4 ? 1000 : 1); ++j) {
+                        spin = spin + j;
+                    }
+                    ++visits[i];
+                }
+            });
+        REQUIRE(std::count(visits.begin(), visits.end(), 1) ==
+                static_cast<long>(count));
+    }
+}
@@ -13,10 +13,10 @@ TEST_CASE("Object tagging") {
     };
     Player player;
     valiant::Renderer renderer(valiant::DISABLE);
-    std::string default_player_tag = player.tag;
+    std::string default_player_tag = player.tag.name();
     renderer.add_object(player);
     renderer.run();
-    std::string new_player_tag = player.tag;
+    std::string new_player_tag = player.tag.name();
     // Test default tag
     REQUIRE(default_player_tag == "untagged");
     // Test new tag value after start method execution
@@ -131,3 +131,30 @@ TEST_CASE("Object get object data") {
         REQUIRE(rectangle_object_data == expected_object_data);
     }
 }
+
+TEST_CASE("Object shared context") {
+    class Mover : public valiant::Object {
+       public:
+        void update() override {
+            transform.position.x += static_cast<float>(time.delta_time);
+        }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    Mover mover_1;
+    Mover mover_2;
+    valiant::Camera camera;
+    renderer.add_object(mover_1);
+    renderer.add_object(mover_2);
+    renderer.add_camera(camera);
+    renderer.run();
+    renderer.step(0.5);
+    // Every object and the camera see the delta of the frame
+    REQUIRE(mover_1.transform.position.x == 0.5);
+    REQUIRE(mover_2.transform.position.x == 0.5);
+    REQUIRE(&mover_1.time == &camera.time);
+    REQUIRE(valiant::Context::time.delta_time == 0.5);
+    // Time and input are not stored in every object
+    REQUIRE(sizeof(valiant::Object) <
+            sizeof(valiant::Transform) + sizeof(valiant::Time) +
+                sizeof(std::string) + sizeof(void *));
+}
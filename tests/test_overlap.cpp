@@ -0,0 +1,83 @@
+#include <SDL2/SDL.h>
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../valiant/collider.hpp"
+#include "../valiant/overlap.hpp"
+
+TEST_CASE("Overlap kernel matches SDL intersection") {
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> position(-100, 100);
+    // Include empty and negative sizes
+    std::uniform_int_distribution<int> size(-5, 60);
+    const size_t rect_count = 2000;
+    std::vector<SDL_Rect> rects(rect_count);
+    valiant::ColliderBuffer buffer;
+    buffer.resize(rect_count);
+    for (size_t i = 0; i < rect_count; ++i) {
+        rects[i] = {position(generator), position(generator), size(generator),
+                    size(generator)};
+        buffer.set(i, rects[i], true);
+    }
+    size_t mismatches = 0;
+    for (size_t i = 0; i < rect_count; ++i) {
+        if (!buffer.enabled[i]) {
+            // Empty rects never intersect and are never used as a query
+            REQUIRE(!SDL_HasIntersection(&rects[i], &rects[0]));
+            continue;
+        }
+        valiant::AABB box = buffer.get(i);
+        for (size_t start = 0; start < rect_count;
+             start += valiant::OVERLAP_BLOCK_SIZE) {
+            size_t count =
+                std::min(valiant::OVERLAP_BLOCK_SIZE, rect_count - start);
+            uint32_t mask = buffer.overlap_mask(box, start, count);
+            for (size_t k = 0; k < count; ++k) {
+                bool expected = SDL_HasIntersection(&rects[i],
+                                                    &rects[start + k]) ==
+                                SDL_TRUE;
+                bool hit = (mask >> k) & 1;
+                if (hit != expected) {
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Overlap kernel block sizes") {
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float> position(-50, 50);
+    std::uniform_real_distribution<float> size(1, 40);
+    valiant::ColliderBuffer buffer;
+    buffer.resize(valiant::OVERLAP_BLOCK_SIZE);
+    for (size_t k = 0; k < valiant::OVERLAP_BLOCK_SIZE; ++k) {
+        float x = position(generator);
+        float y = position(generator);
+        valiant::AABB aabb = {x, y, x + size(generator), y + size(generator)};
+        // Disabled entries must never be reported
+        buffer.set(k, aabb, k % 5 != 0);
+    }
+    valiant::AABB box = {-10, -10, 10, 10};
+    // Every block length exercises a different mix of vector and scalar paths
+    for (size_t count = 0; count <= valiant::OVERLAP_BLOCK_SIZE; ++count) {
+        uint32_t mask = buffer.overlap_mask(box, 0, count);
+        uint32_t expected = valiant::OverlapKernel::mask_scalar(
+            box, &buffer.min_x[0], &buffer.min_y[0], &buffer.max_x[0],
+            &buffer.max_y[0], count);
+        REQUIRE(mask == expected);
+        for (size_t k = 0; k < count; k += 5) {
+            REQUIRE(((mask >> k) & 1) == 0);
+        }
+    }
+}
+
+TEST_CASE("Overlap kernel lowest bit") {
+    REQUIRE(valiant::OverlapKernel::lowest_bit(1) == 0);
+    REQUIRE(valiant::OverlapKernel::lowest_bit(12) == 2);
+    REQUIRE(valiant::OverlapKernel::lowest_bit(0x80000000u) == 31);
+}
@@ -0,0 +1,62 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+
+#include "../valiant/pair_set.hpp"
+
+TEST_CASE("Pair set key ordering") {
+    uint64_t key_1 = valiant::PairSet::make_key(1, 2);
+    uint64_t key_2 = valiant::PairSet::make_key(2, 1);
+    REQUIRE(key_1 == key_2);
+    REQUIRE(valiant::PairSet::first_id(key_1) == 1);
+    REQUIRE(valiant::PairSet::second_id(key_1) == 2);
+    // Keys sort by lower id first, then by higher id
+    REQUIRE(valiant::PairSet::make_key(0, 9) <
+            valiant::PairSet::make_key(1, 2));
+    REQUIRE(valiant::PairSet::make_key(1, 2) <
+            valiant::PairSet::make_key(1, 3));
+}
+
+TEST_CASE("Pair set insertion and lookup") {
+    valiant::PairSet pair_set;
+    REQUIRE(pair_set.empty());
+    REQUIRE(pair_set.contains(valiant::PairSet::make_key(0, 1)) == false);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        REQUIRE(pair_set.insert(valiant::PairSet::make_key(i, i + 1)));
+    }
+    // Inserting an existing pair does not change the set
+    REQUIRE(pair_set.insert(valiant::PairSet::make_key(1, 0)) == false);
+    REQUIRE(pair_set.size() == 1000);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        REQUIRE(pair_set.contains(valiant::PairSet::make_key(i + 1, i)));
+        REQUIRE(pair_set.contains(valiant::PairSet::make_key(i, i + 2)) ==
+                false);
+    }
+    // Capacity grows with the number of pairs stored
+    REQUIRE(pair_set.capacity() <= 4096);
+}
+
+TEST_CASE("Pair set clear") {
+    valiant::PairSet pair_set;
+    pair_set.insert(valiant::PairSet::make_key(3, 4));
+    pair_set.insert(valiant::PairSet::make_key(5, 6));
+    size_t capacity = pair_set.capacity();
+    pair_set.clear();
+    REQUIRE(pair_set.empty());
+    REQUIRE(pair_set.contains(valiant::PairSet::make_key(3, 4)) == false);
+    REQUIRE(pair_set.capacity() == capacity);
+    REQUIRE(pair_set.insert(valiant::PairSet::make_key(3, 4)));
+    REQUIRE(pair_set.keys().size() == 1);
+    // Clearing a set with colliding probe chains empties every slot
+    for (int round = 0; round < 4; ++round) {
+        pair_set.clear();
+        for (uint32_t i = 0; i < 300; ++i) {
+            pair_set.insert(valiant::PairSet::make_key(i * 7, i * 13 + 1));
+        }
+        pair_set.clear();
+        for (uint32_t i = 0; i < 300; ++i) {
+            REQUIRE(pair_set.contains(
+                        valiant::PairSet::make_key(i * 7, i * 13 + 1)) ==
+                    false);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+#include <catch2/catch.hpp>
+#include <vector>
+
+#include "../valiant/registry.hpp"
+#include "../valiant/renderer.hpp"
+#include "../valiant/systems.hpp"
+
+TEST_CASE("Registry entities") {
+    valiant::Registry registry;
+    valiant::Entity entity_1 = registry.create();
+    valiant::Entity entity_2 = registry.create();
+    REQUIRE(registry.size() == 2);
+    REQUIRE(registry.valid(entity_1));
+    registry.destroy(entity_1);
+    REQUIRE(registry.size() == 1);
+    REQUIRE(registry.valid(entity_1) == false);
+    REQUIRE_THROWS_AS(registry.destroy(entity_1), valiant::ValiantError);
+    // Indices are reused with a new version
+    valiant::Entity entity_3 = registry.create();
+    REQUIRE(entity_3.index == entity_1.index);
+    REQUIRE(entity_3 != entity_1);
+    REQUIRE(registry.valid(entity_3));
+    REQUIRE(registry.valid(entity_2));
+}
+
+TEST_CASE("Registry components") {
+    valiant::Registry registry;
+    std::vector<valiant::Entity> entities;
+    for (int i = 0; i < 5; ++i) {
+        valiant::Entity entity = registry.create();
+        registry.add<valiant::Transform>(entity).position.x =
+            static_cast<float>(i);
+        entities.push_back(entity);
+    }
+    registry.add<valiant::Velocity>(entities[1], valiant::Velocity(1, 2, 0));
+    REQUIRE(registry.has<valiant::Velocity>(entities[1]));
+    REQUIRE(registry.has<valiant::Velocity>(entities[0]) == false);
+    REQUIRE(registry.get<valiant::Velocity>(entities[1]).y == 2);
+    REQUIRE_THROWS_AS(registry.get<valiant::Velocity>(entities[0]),
+                      valiant::ValiantError);
+    // Removing keeps the other components packed
+    registry.remove<valiant::Transform>(entities[0]);
+    registry.destroy(entities[2]);
+    REQUIRE(registry.pool<valiant::Transform>().size() == 3);
+    REQUIRE(registry.get<valiant::Transform>(entities[4]).position.x == 4);
+    REQUIRE(registry.get<valiant::Transform>(entities[3]).position.x == 3);
+    REQUIRE(registry.has<valiant::Transform>(entities[2]) == false);
+    // Adding again replaces the component
+    registry.add<valiant::Velocity>(entities[1], valiant::Velocity(3, 0, 0));
+    REQUIRE(registry.pool<valiant::Velocity>().size() == 1);
+    REQUIRE(registry.get<valiant::Velocity>(entities[1]).x == 3);
+    // Only entities with every component are visited
+    size_t visited = 0;
+    registry.each<valiant::Transform, valiant::Velocity>(
+        [&](valiant::Entity entity, valiant::Transform &,
+            valiant::Velocity &) {
+            REQUIRE(entity == entities[1]);
+            ++visited;
+        });
+    REQUIRE(visited == 1);
+}
+
+TEST_CASE("Registry movement system") {
+    valiant::Registry registry;
+    valiant::Entity mover = registry.create();
+    registry.add<valiant::Transform>(mover);
+    registry.add<valiant::Velocity>(mover, valiant::Velocity(10, -20, 0));
+    valiant::Entity still = registry.create();
+    registry.add<valiant::Transform>(still);
+    valiant::update_movement(registry, 0.5);
+    REQUIRE(registry.get<valiant::Transform>(mover).position ==
+            valiant::Vector3(5, -10, 0));
+    REQUIRE(registry.get<valiant::Transform>(still).position ==
+            valiant::Vector3(0, 0, 0));
+}
+
+TEST_CASE("Registry collision system") {
+    valiant::Registry registry;
+    auto add_box = [&registry](float x, float y) {
+        valiant::Entity entity = registry.create();
+        registry.add<valiant::Transform>(entity).position = {x, y, 0};
+        registry.add<valiant::Shape>(entity, valiant::Shape(10, 10));
+        registry.add<valiant::ColliderComponent>(entity);
+        return entity;
+    };
+    valiant::Entity box_1 = add_box(0, 0);
+    valiant::Entity box_2 = add_box(5, 5);
+    valiant::Entity box_3 = add_box(8, -6);
+    // Touching edges do not overlap
+    add_box(-10, 0);
+    valiant::Entity box_5 = add_box(100, 0);
+    valiant::Entity box_6 = add_box(100, 0);
+    valiant::CollisionSystem collision_system;
+    std::vector<valiant::EntityCollision> expected = {
+        {box_1, box_2}, {box_1, box_3}, {box_5, box_6}};
+    REQUIRE(collision_system.update(registry) == expected);
+    // Static pairs, layers that do not accept each other and disabled
+    // colliders are skipped
+    registry.get<valiant::ColliderComponent>(box_5).is_static = true;
+    registry.get<valiant::ColliderComponent>(box_6).is_static = true;
+    registry.get<valiant::ColliderComponent>(box_2).layer = 1;
+    registry.get<valiant::ColliderComponent>(box_1).layer_mask = 1;
+    registry.get<valiant::ColliderComponent>(box_3).enabled = false;
+    REQUIRE(collision_system.update(registry).empty());
+}
+
+TEST_CASE("Registry collision system statics") {
+    valiant::Registry registry;
+    auto add_box = [&registry](float x, int width, bool is_static) {
+        valiant::Entity entity = registry.create();
+        registry.add<valiant::Transform>(entity).position = {x, 0, 0};
+        registry.add<valiant::Shape>(entity, valiant::Shape(width, 10));
+        registry.add<valiant::ColliderComponent>(entity).is_static =
+            is_static;
+        return entity;
+    };
+    // A long wall starting far before the boxes, and a post it overlaps
+    valiant::Entity wall = add_box(0, 1000, true);
+    add_box(-400, 10, true);
+    valiant::Entity box_1 = add_box(400, 10, false);
+    valiant::Entity box_2 = add_box(405, 10, false);
+    add_box(600, 10, false);
+    valiant::CollisionSystem collision_system;
+    std::vector<valiant::EntityCollision> expected = {
+        {wall, box_1}, {wall, box_2}, {box_1, box_2}};
+    REQUIRE(collision_system.update(registry) == expected);
+}
+
+TEST_CASE("Renderer entities") {
+    valiant::Registry registry;
+    for (int i = 0; i < 200; ++i) {
+        valiant::Entity entity = registry.create();
+        registry.add<valiant::Transform>(entity).position.x =
+            static_cast<float>(i) * 100;
+        registry.add<valiant::Shape>(entity, valiant::Shape(10, 10));
+        registry.add<valiant::Velocity>(entity, valiant::Velocity(-60, 0, 0));
+    }
+    valiant::Renderer renderer(valiant::DISABLE);
+    REQUIRE_THROWS_AS(renderer.add_system(valiant::update_movement),
+                      valiant::ValiantError);
+    renderer.set_registry(registry);
+    renderer.add_system(valiant::update_movement);
+    renderer.run();
+    // Entities are moved before they are drawn
+    renderer.step(1.);
+    valiant::RenderStats stats = renderer.render_stats();
+    REQUIRE(stats.drawn == 11);
+    REQUIRE(stats.culled == 189);
+    renderer.set_culling(false);
+    renderer.step(1.);
+    REQUIRE(renderer.render_stats().drawn == 200);
+    valiant::Entity first = {0, 0};
+    REQUIRE(registry.get<valiant::Transform>(first).position.x == -120);
+}
+
+TEST_CASE("Renderer parallel systems") {
+    valiant::Registry registry;
+    for (int i = 0; i < 5000; ++i) {
+        valiant::Entity entity = registry.create();
+        registry.add<valiant::Transform>(entity);
+        // Every other entity moves
+        if (i % 2 == 0) {
+            registry.add<valiant::Velocity>(entity, valiant::Velocity(1, 2, 0));
+        }
+    }
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_update_thread_count(4);
+    renderer.set_registry(registry);
+    renderer.add_parallel_system<valiant::Velocity, valiant::Transform>(
+        valiant::move_entity);
+    renderer.run();
+    renderer.step(0.5);
+    renderer.step(0.5);
+    size_t moved = 0;
+    size_t wrong = 0;
+    registry.each<valiant::Transform>(
+        [&](valiant::Entity entity, valiant::Transform &transform) {
+            valiant::Vector3 expected =
+                entity.index % 2 == 0 ? valiant::Vector3(1, 2, 0)
+                                      : valiant::Vector3(0, 0, 0);
+            if (!(transform.position == expected)) {
+                ++wrong;
+            }
+            if (transform.position.x != 0) {
+                ++moved;
+            }
+        });
+    REQUIRE(wrong == 0);
+    REQUIRE(moved == 2500);
+}
+
+TEST_CASE("Registry entities with a sprite and a shape") {
+    valiant::Registry registry;
+    // Sized by the sprite, like an object with both components
+    valiant::Entity both = registry.create();
+    registry.add<valiant::Transform>(both);
+    registry.add<valiant::Shape>(both, valiant::Shape(4, 4));
+    registry.add<valiant::SpriteRendererComponent>(both).sprite =
+        "examples/assets/sprite.png";
+    registry.add<valiant::ColliderComponent>(both);
+    valiant::Entity box = registry.create();
+    registry.add<valiant::Transform>(box).position = {12, 0, 0};
+    registry.add<valiant::Shape>(box, valiant::Shape(4, 4));
+    registry.add<valiant::ColliderComponent>(box);
+    int sprite_width =
+        registry.get<valiant::SpriteRendererComponent>(both).sprite.width;
+    REQUIRE(sprite_width > 24);
+    valiant::ObjectData entity_data = valiant::get_entity_data(
+        registry.pool<valiant::SpriteRendererComponent>(),
+        registry.pool<valiant::Shape>(), both,
+        registry.get<valiant::Transform>(both));
+    REQUIRE(entity_data.width == sprite_width);
+    valiant::CollisionSystem collision_system;
+    std::vector<valiant::EntityCollision> expected = {{both, box}};
+    REQUIRE(collision_system.update(registry) == expected);
+    // Drawn once, as its sprite
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_registry(registry);
+    renderer.run();
+    renderer.step(1. / 60);
+    renderer.step(1. / 60);
+    REQUIRE(registry.get<valiant::SpriteRendererComponent>(both).sprite.ready);
+    REQUIRE(renderer.render_stats().drawn == 2);
+    REQUIRE(renderer.render_stats().culled == 0);
+}
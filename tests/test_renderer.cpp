@@ -1,13 +1,32 @@
 #include <SDL2/SDL.h>
 
+#include <atomic>
 #include <catch2/catch.hpp>
 #include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "../valiant/collider.hpp"
 #include "../valiant/color.hpp"
 #include "../valiant/object.hpp"
 #include "../valiant/renderer.hpp"
 
+// Count every heap allocation made by the test binary
+static std::atomic<size_t> allocation_count(0);
+
+void *operator new(size_t size) {
+    ++allocation_count;
+    if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
 void test_object_camera_position(const valiant::Renderer &renderer,
                                  valiant::ObjectData object,
                                  valiant::CameraData camera) {
@@ -232,6 +251,257 @@ TEST_CASE("Renderer collision processing") {
     }
 }
 
+class CollisionRecorder : public valiant::Object,
+                          public valiant::Rectangle,
+                          public valiant::Collider {
+   public:
+    CollisionRecorder(std::vector<std::string> &log, int id) : log_(log) {
+        tag = std::to_string(id);
+        shape.width = 40;
+        shape.height = 40;
+    }
+
+    void on_collision_enter(const valiant::Collision &collision) override {
+        log_.push_back(tag.name() + " enter " + collision.tag.name());
+    }
+
+    void on_collision_stay(const valiant::Collision &collision) override {
+        log_.push_back(tag.name() + " stay " + collision.tag.name());
+    }
+
+    void on_collision_exit(const valiant::Collision &collision) override {
+        log_.push_back(tag.name() + " exit " + collision.tag.name());
+    }
+
+   private:
+    std::vector<std::string> &log_;
+};
+
+// Move randomly walking colliders for a number of frames and record every
+// callback in order. Layered runs spread colliders over a few layers with
+// random masks, runs with statics keep every fourth collider in place.
+std::vector<std::string> record_collisions(valiant::BroadPhase broad_phase,
+                                           size_t thread_count,
+                                           bool layered = false,
+                                           bool with_statics = false) {
+    const int object_count = 200;
+    std::vector<std::string> log;
+    std::vector<CollisionRecorder> objects;
+    objects.reserve(object_count);
+    std::vector<valiant::Object *> pointers;
+    for (int i = 0; i < object_count; ++i) {
+        objects.emplace_back(log, i);
+        pointers.push_back(&objects.back());
+    }
+    valiant::CollisionManager collision_manager;
+    collision_manager.set_broad_phase(broad_phase);
+    collision_manager.set_thread_count(thread_count);
+    collision_manager.fill_collider_objects(pointers);
+    valiant::CameraData camera_data = {1., {0, 0, 0}};
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> position(-400, 400);
+    std::uniform_int_distribution<int> step(-15, 15);
+    for (CollisionRecorder &object : objects) {
+        object.transform.position = {static_cast<float>(position(generator)),
+                                     static_cast<float>(position(generator)),
+                                     0};
+    }
+    if (layered) {
+        std::mt19937 layer_generator(7);
+        std::uniform_int_distribution<int> layer(0, 3);
+        std::uniform_int_distribution<uint32_t> mask(0, 15);
+        for (CollisionRecorder &object : objects) {
+            object.collider.layer =
+                static_cast<uint8_t>(layer(layer_generator));
+            object.collider.layer_mask = mask(layer_generator);
+        }
+    }
+    if (with_statics) {
+        for (size_t i = 0; i < objects.size(); i += 4) {
+            objects[i].collider.is_static = true;
+        }
+    }
+    for (int frame = 0; frame < 30; ++frame) {
+        for (CollisionRecorder &object : objects) {
+            int step_x = step(generator);
+            int step_y = step(generator);
+            if (!object.collider.is_static) {
+                object.transform.position.x += step_x;
+                object.transform.position.y += step_y;
+            }
+            // Occasionally disable colliders to exercise exit callbacks
+            object.collider.enabled = (step(generator) % 13) != 0;
+        }
+        collision_manager.process_collisions(camera_data);
+    }
+    return log;
+}
+
+TEST_CASE("Renderer broad phase callback order") {
+    std::vector<std::string> brute_force_log =
+        record_collisions(valiant::BroadPhase::BRUTE_FORCE, 1);
+    std::vector<std::string> sweep_log =
+        record_collisions(valiant::BroadPhase::SWEEP_AND_PRUNE, 1);
+    REQUIRE(!brute_force_log.empty());
+    REQUIRE(sweep_log == brute_force_log);
+}
+
+TEST_CASE("Renderer layered broad phase callback order") {
+    std::vector<std::string> brute_force_log =
+        record_collisions(valiant::BroadPhase::BRUTE_FORCE, 1, true);
+    REQUIRE(!brute_force_log.empty());
+    REQUIRE(brute_force_log.size() <
+            record_collisions(valiant::BroadPhase::BRUTE_FORCE, 1).size());
+    REQUIRE(record_collisions(valiant::BroadPhase::SWEEP_AND_PRUNE, 1, true) ==
+            brute_force_log);
+    REQUIRE(record_collisions(valiant::BroadPhase::SWEEP_AND_PRUNE, 3, true) ==
+            brute_force_log);
+}
+
+TEST_CASE("Renderer static collider callback order") {
+    std::vector<std::string> brute_force_log =
+        record_collisions(valiant::BroadPhase::BRUTE_FORCE, 1, true, true);
+    REQUIRE(!brute_force_log.empty());
+    REQUIRE(record_collisions(valiant::BroadPhase::SWEEP_AND_PRUNE, 1, true,
+                              true) == brute_force_log);
+    REQUIRE(record_collisions(valiant::BroadPhase::SWEEP_AND_PRUNE, 3, true,
+                              true) == brute_force_log);
+}
+
+TEST_CASE("Renderer static colliders") {
+    std::vector<std::string> log;
+    std::vector<CollisionRecorder> objects;
+    objects.reserve(3);
+    std::vector<valiant::Object *> pointers;
+    for (int i = 0; i < 3; ++i) {
+        objects.emplace_back(log, i);
+        pointers.push_back(&objects.back());
+    }
+    // 0 and 1 are overlapping walls, 2 moves into wall 1
+    objects[0].collider.is_static = true;
+    objects[1].collider.is_static = true;
+    objects[1].transform.position.x = 20;
+    objects[2].transform.position.x = 100;
+    valiant::CollisionManager collision_manager;
+    collision_manager.fill_collider_objects(pointers);
+    valiant::CameraData camera_data = {1., {0, 0, 0}};
+    collision_manager.set_broad_phase(
+        GENERATE(valiant::BroadPhase::BRUTE_FORCE,
+                 valiant::BroadPhase::SWEEP_AND_PRUNE));
+
+    SECTION("Static pairs are not tested") {
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log.empty());
+        objects[2].transform.position.x = 50;
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log == std::vector<std::string>{"1 enter 2", "2 enter 1"});
+        REQUIRE(collision_manager.contacts_size() == 1);
+    }
+
+    SECTION("Static bounds are cached") {
+        collision_manager.process_collisions(camera_data);
+        objects[1].transform.position.x = 100;
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log.empty());
+        collision_manager.invalidate_static_colliders();
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log == std::vector<std::string>{"1 enter 2", "2 enter 1"});
+    }
+
+    SECTION("Moving the camera projects statics again") {
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(collision_manager.static_builds() == 1);
+        for (int frame = 1; frame <= 10; ++frame) {
+            camera_data.position.x = 37.5f * frame;
+            camera_data.position.y = -11.25f * frame;
+            collision_manager.process_collisions(camera_data);
+        }
+        REQUIRE(log.empty());
+        // Only found if wall 1 was projected through the moved camera
+        objects[2].transform.position.x = 50;
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log == std::vector<std::string>{"1 enter 2", "2 enter 1"});
+        REQUIRE(collision_manager.static_builds() == 1);
+        // Resizing the camera rebuilds them
+        camera_data.size = 2;
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(collision_manager.static_builds() == 2);
+    }
+
+    SECTION("Component changes rebuild statics") {
+        objects[2].transform.position.x = 50;
+        collision_manager.process_collisions(camera_data);
+        log.clear();
+        objects[1].collider.enabled = false;
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log == std::vector<std::string>{"1 exit 2", "2 exit 1"});
+        log.clear();
+        // A static collider made dynamic collides with the other wall
+        objects[1].collider.enabled = true;
+        objects[1].collider.is_static = false;
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log == std::vector<std::string>{"0 enter 1", "1 enter 0",
+                                                "1 enter 2", "2 enter 1"});
+    }
+}
+
+TEST_CASE("Renderer collision layers") {
+    std::vector<std::string> log;
+    std::vector<CollisionRecorder> objects;
+    objects.reserve(4);
+    std::vector<valiant::Object *> pointers;
+    for (int i = 0; i < 4; ++i) {
+        objects.emplace_back(log, i);
+        pointers.push_back(&objects.back());
+    }
+    const uint8_t player_layer = 0;
+    const uint8_t bullet_layer = 1;
+    // 0 is a player, 1 to 3 are bullets that only hit the player. All four
+    // overlap.
+    for (size_t i = 1; i < objects.size(); ++i) {
+        objects[i].collider.layer = bullet_layer;
+        objects[i].collider.layer_mask = 1u << player_layer;
+        objects[i].transform.position.x = static_cast<float>(i);
+    }
+    valiant::CollisionManager collision_manager;
+    collision_manager.fill_collider_objects(pointers);
+    valiant::CameraData camera_data = {1., {0, 0, 0}};
+    collision_manager.set_broad_phase(
+        GENERATE(valiant::BroadPhase::BRUTE_FORCE,
+                 valiant::BroadPhase::SWEEP_AND_PRUNE));
+    collision_manager.process_collisions(camera_data);
+    REQUIRE(log == std::vector<std::string>{"0 enter 1", "1 enter 0",
+                                            "0 enter 2", "2 enter 0",
+                                            "0 enter 3", "3 enter 0"});
+
+    SECTION("Masks have to accept each other") {
+        // The player stops accepting bullets
+        log.clear();
+        objects[0].collider.layer_mask = 1u << player_layer;
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log == std::vector<std::string>{"0 exit 1", "1 exit 0",
+                                                "0 exit 2", "2 exit 0",
+                                                "0 exit 3", "3 exit 0"});
+    }
+
+    SECTION("Invalid layer") {
+        objects[2].collider.layer = valiant::COLLIDER_LAYER_COUNT;
+        REQUIRE_THROWS_WITH(collision_manager.process_collisions(camera_data),
+                            "Invalid collider layer: 32");
+    }
+}
+
+TEST_CASE("Renderer multithreaded collision callback order") {
+    std::vector<std::string> expected_log =
+        record_collisions(valiant::BroadPhase::BRUTE_FORCE, 1);
+    for (size_t thread_count = 2; thread_count <= 4; ++thread_count) {
+        REQUIRE(record_collisions(valiant::BroadPhase::BRUTE_FORCE,
+                                  thread_count) == expected_log);
+        REQUIRE(record_collisions(valiant::BroadPhase::SWEEP_AND_PRUNE,
+                                  thread_count) == expected_log);
+    }
+}
+
 TEST_CASE("Renderer is colliding method") {
     SECTION("Test intersecting") {
         SDL_Rect rect_1 = {0, 0, 50, 50};
@@ -249,6 +519,59 @@ TEST_CASE("Renderer is colliding method") {
     }
 }
 
+TEST_CASE("Renderer world space collision") {
+    class Box : public valiant::Object,
+                public valiant::Rectangle,
+                public valiant::Collider {
+       public:
+        int enter_count{0};
+        int exit_count{0};
+
+        void on_collision_enter(
+            const valiant::Collision &collision) override {
+            ++enter_count;
+        }
+
+        void on_collision_exit(const valiant::Collision &collision) override {
+            ++exit_count;
+        }
+    };
+    SECTION("World bounds") {
+        valiant::ObjectData object_data = {20, 10, {5.5, -1, 0}};
+        valiant::AABB bounds =
+            valiant::ObjectManager::get_object_world_bounds(object_data);
+        valiant::AABB expected_bounds = {-4.5, -6, 15.5, 4};
+        REQUIRE(bounds == expected_bounds);
+    }
+    SECTION("Is colliding") {
+        valiant::AABB aabb_1 = {0, 0, 50, 50};
+        valiant::AABB aabb_2 = {49.5, 49.5, 99.5, 99.5};
+        valiant::AABB aabb_3 = {50, 0, 100, 50};
+        valiant::AABB empty = {10, 10, 10, 20};
+        REQUIRE(valiant::CollisionManager::is_colliding(aabb_1, aabb_2));
+        // Touching edges do not collide
+        REQUIRE(!valiant::CollisionManager::is_colliding(aabb_1, aabb_3));
+        REQUIRE(!valiant::CollisionManager::is_colliding(aabb_1, empty));
+    }
+    SECTION("Collision without camera") {
+        Box box_1;
+        Box box_2;
+        box_1.shape = valiant::Shape(10, 10);
+        box_2.shape = valiant::Shape(10, 10);
+        // Sub-pixel overlap that integer screen rects would round away
+        box_2.transform.position = {9.75, 0, 0};
+        valiant::CollisionManager collision_manager;
+        collision_manager.fill_collider_objects({&box_1, &box_2});
+        collision_manager.process_collisions();
+        REQUIRE(box_1.enter_count == 1);
+        REQUIRE(box_2.enter_count == 1);
+        box_2.transform.position = {10, 0, 0};
+        collision_manager.process_collisions();
+        REQUIRE(box_1.exit_count == 1);
+        REQUIRE(box_2.exit_count == 1);
+    }
+}
+
 TEST_CASE("Renderer get collision from object") {
     valiant::Object object;
     valiant::Collision collision_1 =
@@ -281,6 +604,476 @@ TEST_CASE("Renderer collider object registration") {
     REQUIRE(collider_size == 1);
 }
 
+TEST_CASE("Renderer object components") {
+    class SpriteCollider : public valiant::Object,
+                           public valiant::SpriteRenderer,
+                           public valiant::Collider {};
+    class RectangleObject : public valiant::Object,
+                            public valiant::Rectangle {};
+    SpriteCollider sprite_collider;
+    RectangleObject rectangle_object;
+    valiant::ObjectComponents components =
+        valiant::get_object_components(sprite_collider);
+    REQUIRE(components.object == &sprite_collider);
+    REQUIRE(components.sprite_renderer == &sprite_collider);
+    REQUIRE(components.rectangle == nullptr);
+    REQUIRE(components.collider == &sprite_collider);
+    // Components are found at runtime when only the base type is known
+    valiant::Object &object = rectangle_object;
+    components = valiant::get_object_components(object);
+    REQUIRE(components.object == &rectangle_object);
+    REQUIRE(components.sprite_renderer == nullptr);
+    REQUIRE(components.rectangle == &rectangle_object);
+    REQUIRE(components.collider == nullptr);
+}
+
+TEST_CASE("Renderer collider removal") {
+    std::vector<std::string> log;
+    std::vector<CollisionRecorder> objects;
+    objects.reserve(4);
+    for (int i = 0; i < 4; ++i) {
+        objects.emplace_back(log, i);
+    }
+    objects[1].collider.is_static = true;
+    valiant::CollisionManager collision_manager;
+    collision_manager.fill_collider_objects(
+        {&objects[0], &objects[1], &objects[2]});
+    valiant::CameraData camera_data = {1., {0, 0, 0}};
+    collision_manager.process_collisions(camera_data);
+    log.clear();
+
+    SECTION("Removed colliders receive exit callbacks") {
+        collision_manager.remove_collider_objects({&objects[1]});
+        REQUIRE(log == std::vector<std::string>{"0 exit 1", "1 exit 0",
+                                                "1 exit 2", "2 exit 1"});
+        REQUIRE(collision_manager.collider_objects_size() == 2);
+        REQUIRE(collision_manager.contacts_size() == 1);
+        log.clear();
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log == std::vector<std::string>{"0 stay 2", "2 stay 0"});
+    }
+
+    SECTION("Added colliders keep existing contacts") {
+        collision_manager.remove_collider_objects({&objects[0]});
+        collision_manager.fill_collider_objects({&objects[3]});
+        log.clear();
+        collision_manager.process_collisions(camera_data);
+        REQUIRE(log == std::vector<std::string>{"1 stay 2", "2 stay 1",
+                                                "1 enter 3", "3 enter 1",
+                                                "2 enter 3", "3 enter 2"});
+    }
+}
+
+TEST_CASE("Renderer runtime object changes") {
+    class Counter : public valiant::Object,
+                    public valiant::Rectangle,
+                    public valiant::Collider {
+       public:
+        int awake_calls{0};
+        int start_calls{0};
+        int exit_calls{0};
+
+        Counter() { shape = valiant::Shape(10, 10); }
+
+        void awake() override { ++awake_calls; }
+        void start() override { ++start_calls; }
+        void on_collision_exit(const valiant::Collision &) override {
+            ++exit_calls;
+        }
+    };
+    class Spawner : public valiant::Object {
+       public:
+        Spawner(valiant::Renderer &renderer, Counter &spawned)
+            : renderer_(renderer), spawned_(spawned) {}
+
+        void start() override {
+            renderer_.add_object(spawned_);
+            renderer_.remove_object(*this);
+        }
+
+       private:
+        valiant::Renderer &renderer_;
+        Counter &spawned_;
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    Counter counter;
+    Counter spawned;
+    Spawner spawner(renderer, spawned);
+    renderer.add_object(counter);
+    renderer.add_object(spawner);
+    renderer.run();
+    // Changes made by start methods are applied once they have all run
+    REQUIRE(renderer.get_objects() ==
+            std::vector<valiant::Object *>{&counter, &spawned});
+    REQUIRE(counter.start_calls == 1);
+    REQUIRE(spawned.awake_calls == 1);
+    REQUIRE(spawned.start_calls == 1);
+    // Counter and spawned overlap
+    renderer.step(1. / 60);
+    // Objects queued for addition and removed again are never added
+    Counter discarded;
+    renderer.add_object(discarded);
+    renderer.remove_object(discarded);
+    // Removal is applied at the end of the frame
+    renderer.remove_object(counter);
+    REQUIRE(renderer.get_objects() ==
+            std::vector<valiant::Object *>{&counter, &spawned});
+    renderer.step(1. / 60);
+    REQUIRE(renderer.get_objects() ==
+            std::vector<valiant::Object *>{&spawned});
+    REQUIRE(counter.exit_calls == 1);
+    REQUIRE(spawned.exit_calls == 1);
+    renderer.step(1. / 60);
+    REQUIRE(counter.exit_calls == 1);
+    REQUIRE(spawned.exit_calls == 1);
+    REQUIRE(discarded.awake_calls == 0);
+    REQUIRE(discarded.start_calls == 0);
+    REQUIRE(discarded.exit_calls == 0);
+}
+
+TEST_CASE("Renderer steady state frames do not allocate") {
+    class SpriteObject : public valiant::Object,
+                         public valiant::SpriteRenderer,
+                         public valiant::Collider {
+       public:
+        void awake() override {
+            // Long enough to not fit in a small string buffer
+            sprite_renderer.sprite = "examples/assets/sprite.png";
+        }
+    };
+    class RectangleObject : public valiant::Object,
+                            public valiant::Rectangle,
+                            public valiant::Collider {
+       public:
+        RectangleObject() { shape = valiant::Shape(10, 10); }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    std::vector<SpriteObject> sprites(100);
+    std::vector<RectangleObject> rectangles(100);
+    for (size_t i = 0; i < sprites.size(); ++i) {
+        sprites[i].transform.position.x = static_cast<float>(i * 4);
+        rectangles[i].transform.position.x = static_cast<float>(i * 4);
+        renderer.add_object(sprites[i]);
+        renderer.add_object(rectangles[i]);
+    }
+    renderer.run();
+    // Scratch storage grows during the first frames
+    for (int frame = 0; frame < 3; ++frame) {
+        renderer.step(1. / 60);
+    }
+    size_t allocations = allocation_count;
+    for (int frame = 0; frame < 10; ++frame) {
+        renderer.step(1. / 60);
+    }
+    REQUIRE(allocation_count == allocations);
+}
+
+TEST_CASE("Renderer uploads background loads") {
+    class SpriteObject : public valiant::Object,
+                         public valiant::SpriteRenderer {
+       public:
+        void awake() override {
+            sprite_renderer.sprite.load_async("examples/assets/sprite.png",
+                                              16, 16);
+        }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_placeholder_color(valiant::Color(255, 0, 255));
+    SpriteObject sprite_object;
+    renderer.add_object(sprite_object);
+    renderer.run();
+    valiant::Sprite &sprite = sprite_object.sprite_renderer.sprite;
+    // Placeholder is drawn until the image is uploaded by a later frame
+    for (int frame = 0; frame < 1000 && !sprite.ready; ++frame) {
+        renderer.step(1. / 60);
+        if (!sprite.ready) {
+            SDL_Delay(1);
+        }
+    }
+    REQUIRE(sprite.ready);
+    REQUIRE(sprite.image->is_uploaded());
+    REQUIRE(sprite.width == sprite.image->width);
+    REQUIRE(sprite.height == sprite.image->height);
+}
+
+TEST_CASE("Renderer failed background loads") {
+    class SpriteObject : public valiant::Object,
+                         public valiant::SpriteRenderer {
+       public:
+        void awake() override {
+            sprite_renderer.sprite.load_async("missing sprite path", 16, 16);
+        }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    SpriteObject sprite_object;
+    renderer.add_object(sprite_object);
+    renderer.run();
+    // Thrown by the first frame drawing the sprite after decoding failed
+    bool thrown = false;
+    for (int frame = 0; frame < 1000 && !thrown; ++frame) {
+        try {
+            renderer.step(1. / 60);
+        } catch (const valiant::ValiantError &) {
+            thrown = true;
+        }
+        SDL_Delay(1);
+    }
+    REQUIRE(thrown);
+    REQUIRE(sprite_object.sprite_renderer.sprite.image->error.empty() ==
+            false);
+    REQUIRE(sprite_object.sprite_renderer.sprite.ready == false);
+}
+
+TEST_CASE("Renderer static colliders with background loaded sprites") {
+    class Wall : public valiant::Object,
+                 public valiant::SpriteRenderer,
+                 public valiant::Collider {
+       public:
+        void awake() override {
+            collider.is_static = true;
+            // Placeholder far smaller than the image
+            sprite_renderer.sprite.load_async("examples/assets/sprite.png", 1,
+                                              1);
+        }
+    };
+    class Box : public valiant::Object,
+                public valiant::Rectangle,
+                public valiant::Collider {
+       public:
+        int enter_calls{0};
+
+        void on_collision_enter(const valiant::Collision &) override {
+            ++enter_calls;
+        }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    Wall wall;
+    Box box;
+    // Only overlaps the wall once the wall has its image size
+    box.shape = valiant::Shape(4, 4);
+    box.transform.position.x = 12;
+    renderer.add_object(wall);
+    renderer.add_object(box);
+    renderer.run();
+    valiant::Sprite &sprite = wall.sprite_renderer.sprite;
+    for (int frame = 0; frame < 1000 && !sprite.ready; ++frame) {
+        renderer.step(1. / 60);
+        if (!sprite.ready) {
+            SDL_Delay(1);
+        }
+    }
+    REQUIRE(sprite.ready);
+    REQUIRE(sprite.width > 28);
+    REQUIRE(box.enter_calls == 1);
+}
+
+TEST_CASE("Renderer culls objects outside the camera") {
+    class Box : public valiant::Object,
+                public valiant::Rectangle,
+                public valiant::Collider {
+       public:
+        Box() { shape = valiant::Shape(10, 10); }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    // A row of boxes, every other one static, reaching well past the window
+    std::vector<Box> boxes(200);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        boxes[i].transform.position.x = static_cast<float>(i) * 100;
+        boxes[i].collider.is_static = i % 2 == 0;
+        renderer.add_object(boxes[i]);
+    }
+    renderer.run();
+    // Objects on screen are within 960 logical pixels of the camera
+    renderer.step(1. / 60);
+    valiant::RenderStats stats = renderer.render_stats();
+    REQUIRE(stats.drawn == 10);
+    REQUIRE(stats.culled == 190);
+    // Moving objects are placed again every frame
+    boxes[101].transform.position.x = 0;
+    renderer.step(1. / 60);
+    REQUIRE(renderer.render_stats().drawn == 11);
+    // Static objects once invalidated
+    boxes[100].transform.position.x = 0;
+    renderer.step(1. / 60);
+    REQUIRE(renderer.render_stats().drawn == 11);
+    renderer.invalidate_static_colliders();
+    renderer.step(1. / 60);
+    REQUIRE(renderer.render_stats().drawn == 12);
+    renderer.set_culling(false);
+    renderer.step(1. / 60);
+    stats = renderer.render_stats();
+    REQUIRE(stats.drawn == 200);
+    REQUIRE(stats.culled == 0);
+}
+
+TEST_CASE("Renderer draw order") {
+    class Box : public valiant::Object, public valiant::Rectangle {
+       public:
+        Box() { shape = valiant::Shape(10, 10); }
+    };
+    class SpriteObject : public valiant::Object,
+                         public valiant::SpriteRenderer {};
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_texture_atlas(false);
+    std::vector<Box> boxes(4);
+    const float z[] = {2, 0, 1, 0};
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        boxes[i].transform.position.z = z[i];
+        renderer.add_object(boxes[i]);
+    }
+    renderer.run();
+    renderer.step(1. / 60);
+    // By z, ties in the order objects were added
+    std::vector<valiant::Object *> expected = {&boxes[1], &boxes[3],
+                                               &boxes[2], &boxes[0]};
+    REQUIRE(renderer.get_draw_order() == expected);
+    // Changed z is picked up by the next frame
+    boxes[1].transform.position.z = 3;
+    renderer.step(1. / 60);
+    expected = {&boxes[3], &boxes[2], &boxes[0], &boxes[1]};
+    REQUIRE(renderer.get_draw_order() == expected);
+    // Off-screen objects are not drawn
+    boxes[3].transform.position.x = 10000;
+    renderer.step(1. / 60);
+    expected = {&boxes[2], &boxes[0], &boxes[1]};
+    REQUIRE(renderer.get_draw_order() == expected);
+    boxes[3].transform.position.x = 0;
+    renderer.step(1. / 60);
+    expected = {&boxes[3], &boxes[2], &boxes[0], &boxes[1]};
+    REQUIRE(renderer.get_draw_order() == expected);
+    SECTION("Sprites sharing an image are grouped") {
+        std::vector<SpriteObject> sprites(3);
+        sprites[0].sprite_renderer.sprite = "examples/assets/sprite.png";
+        sprites[1].sprite_renderer.sprite = "./examples/assets/sprite.png";
+        sprites[2].sprite_renderer.sprite = "examples/assets/sprite.png";
+        for (SpriteObject &sprite : sprites) {
+            renderer.add_object(sprite);
+        }
+        renderer.step(1. / 60);
+        renderer.step(1. / 60);
+        std::vector<valiant::Object *> order = renderer.get_draw_order();
+        REQUIRE(order.size() == 7);
+        // Rectangles have no texture and come first at z 0
+        REQUIRE(order[0] == &boxes[3]);
+        bool grouped =
+            (order[1] == &sprites[0] && order[2] == &sprites[2]) ||
+            (order[2] == &sprites[0] && order[3] == &sprites[2]);
+        REQUIRE(grouped);
+        renderer.set_texture_grouping(false);
+        renderer.step(1. / 60);
+        order = renderer.get_draw_order();
+        REQUIRE(order[1] == &sprites[0]);
+        REQUIRE(order[2] == &sprites[1]);
+        REQUIRE(order[3] == &sprites[2]);
+    }
+}
+
+TEST_CASE("Renderer batches rectangles by color and fill") {
+    class Box : public valiant::Object, public valiant::Rectangle {
+       public:
+        Box() { shape = valiant::Shape(10, 10); }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    std::vector<Box> boxes(100);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        // Alternating colors, a few outlines
+        boxes[i].shape.color = i % 2 ? valiant::Color(255, 0, 0)
+                                     : valiant::Color(0, 0, 255);
+        boxes[i].shape.fill = i % 10 != 0;
+        renderer.add_object(boxes[i]);
+    }
+    renderer.run();
+    renderer.step(1. / 60);
+    valiant::RenderStats stats = renderer.render_stats();
+    REQUIRE(stats.drawn == 100);
+    // Filled red, filled blue and outlined blue
+    REQUIRE(stats.batches == 3);
+    // Objects at another z are batched separately
+    boxes[2].transform.position.z = 1;
+    renderer.step(1. / 60);
+    REQUIRE(renderer.render_stats().batches == 4);
+    // Without grouping only consecutive rectangles are batched
+    renderer.set_texture_grouping(false);
+    renderer.step(1. / 60);
+    REQUIRE(renderer.render_stats().batches == 99);
+}
+
+TEST_CASE("Renderer draw order after many changes") {
+    class Box : public valiant::Object, public valiant::Rectangle {
+       public:
+        Box() { shape = valiant::Shape(10, 10); }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    std::vector<Box> boxes(500);
+    for (Box &box : boxes) {
+        renderer.add_object(box);
+    }
+    renderer.run();
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<int> z(0, 20);
+    size_t unsorted_frames = 0;
+    for (int frame = 0; frame < 5; ++frame) {
+        // Few changes on odd frames, every object on even frames
+        for (size_t i = 0; i < boxes.size(); i += frame % 2 ? 50 : 1) {
+            boxes[i].transform.position.z = static_cast<float>(z(generator));
+        }
+        renderer.step(1. / 60);
+        std::vector<valiant::Object *> order = renderer.get_draw_order();
+        bool sorted = order.size() == boxes.size();
+        for (size_t i = 1; sorted && i < order.size(); ++i) {
+            float z_1 = order[i - 1]->transform.position.z;
+            float z_2 = order[i]->transform.position.z;
+            sorted = z_1 < z_2 || (z_1 == z_2 && order[i - 1] < order[i]);
+        }
+        if (!sorted) {
+            ++unsorted_frames;
+        }
+    }
+    REQUIRE(unsorted_frames == 0);
+}
+
+TEST_CASE("Renderer fixed timestep") {
+    class Counter : public valiant::Object {
+       public:
+        int updates{0};
+        double simulated{0};
+
+        void update() override {
+            ++updates;
+            simulated += time.delta_time;
+        }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    Counter counter;
+    renderer.add_object(counter);
+    renderer.set_fixed_timestep(0.25);
+    renderer.run();
+    // Three whole steps, half a step left over
+    renderer.step(0.875);
+    REQUIRE(counter.updates == 3);
+    REQUIRE(counter.simulated == 0.75);
+    REQUIRE(counter.time.alpha == 0.5);
+    // Short frames run no step and are only drawn
+    renderer.step(0.0625);
+    REQUIRE(counter.updates == 3);
+    REQUIRE(counter.time.alpha == 0.75);
+    // Long frames are capped, the time beyond the cap is dropped
+    renderer.step(10.);
+    REQUIRE(counter.updates == 3 + valiant::MAX_FIXED_STEPS_PER_FRAME);
+    REQUIRE(counter.time.alpha == 0.75);
+    // Back to one update per frame
+    renderer.set_fixed_timestep(0);
+    renderer.step(0.1);
+    REQUIRE(counter.updates == 4 + valiant::MAX_FIXED_STEPS_PER_FRAME);
+    REQUIRE(counter.time.delta_time == 0.1);
+    REQUIRE_THROWS_AS(renderer.set_fixed_timestep(-1),
+                      valiant::ValiantError);
+    REQUIRE_THROWS_AS(renderer.set_fixed_timestep(0.1, 0),
+                      valiant::ValiantError);
+    REQUIRE_THROWS_AS(renderer.set_frame_rate_limit(-60),
+                      valiant::ValiantError);
+}
+
 TEST_CASE("Renderer get window flags") {
     uint_fast8_t input_window_flags = valiant::FULLSCREEN;
     uint32_t output_window_flags =
@@ -315,3 +1108,83 @@ TEST_CASE("Renderer set invalid window size") {
     REQUIRE_THROWS_WITH(renderer.set_window_size(0, 0),
                         "Window size must be > 0");
 }
+
+TEST_CASE("Renderer parallel updates") {
+    // Counts the frames it has seen, read by the parallel objects
+    class Clock : public valiant::Object {
+       public:
+        int frames{0};
+
+        void update() override { ++frames; }
+    };
+    class Agent : public valiant::Object, public valiant::ParallelUpdate {
+       public:
+        const Clock *before{nullptr};
+        const Clock *after{nullptr};
+        int updates{0};
+        bool in_order{true};
+
+        void update() override {
+            ++updates;
+            // Objects added before are updated, objects added after are not
+            in_order = in_order && before->frames == updates &&
+                       after->frames == updates - 1;
+            transform.position.x += 1;
+        }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    renderer.set_update_thread_count(4);
+    REQUIRE(renderer.update_thread_count() == 4);
+    Clock before;
+    Clock after;
+    std::vector<Agent> agents(5000);
+    renderer.add_object(before);
+    for (Agent &agent : agents) {
+        agent.before = &before;
+        agent.after = &after;
+        renderer.add_object(agent);
+    }
+    renderer.add_object(after);
+    renderer.run();
+    for (int frame = 0; frame < 3; ++frame) {
+        renderer.step(1. / 60);
+    }
+    // Every agent updated once per frame, in add order around the clocks
+    size_t wrong_agents = 0;
+    for (const Agent &agent : agents) {
+        if (agent.updates != 3 || !agent.in_order ||
+            agent.transform.position.x != 3) {
+            ++wrong_agents;
+        }
+    }
+    REQUIRE(wrong_agents == 0);
+    renderer.set_update_thread_count(0);
+    REQUIRE(renderer.update_thread_count() >= 1);
+}
+
+TEST_CASE("Renderer headless frames") {
+    class Counter : public valiant::Object, public valiant::Rectangle {
+       public:
+        int starts{0};
+        int updates{0};
+
+        void start() override { ++starts; }
+
+        void update() override { ++updates; }
+    };
+    valiant::Renderer renderer(valiant::HEADLESS);
+    Counter counter;
+    counter.shape = valiant::Shape(10, 10);
+    renderer.add_object(counter);
+    // Starts objects on the first call only
+    renderer.run_frames(2, 0.1);
+    renderer.run_frames(1, 0.1);
+    REQUIRE(counter.starts == 1);
+    REQUIRE(counter.updates == 3);
+    REQUIRE(renderer.render_stats().drawn == 1);
+    valiant::FrameTimings timings = renderer.frame_timings();
+    REQUIRE(timings.update >= 0);
+    REQUIRE(timings.render >= 0);
+    REQUIRE(timings.total() == Approx(timings.update + timings.collision +
+                                      timings.render + timings.present));
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../valiant/spatial_grid.hpp"
+
+static bool aabb_overlap(const valiant::AABB &aabb_1,
+                         const valiant::AABB &aabb_2) {
+    return aabb_1.min_x <= aabb_2.max_x && aabb_1.max_x >= aabb_2.min_x &&
+           aabb_1.min_y <= aabb_2.max_y && aabb_1.max_y >= aabb_2.min_y;
+}
+
+TEST_CASE("Spatial grid queries match brute force") {
+    valiant::SpatialGrid grid(64);
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<float> position(-1000, 1000);
+    // Some bounds are larger than a cell
+    std::uniform_real_distribution<float> size(1, 100);
+    std::vector<valiant::AABB> bounds(500);
+    auto random_bounds = [&]() {
+        float x = position(generator);
+        float y = position(generator);
+        return valiant::AABB{x, y, x + size(generator), y + size(generator)};
+    };
+    for (uint32_t i = 0; i < bounds.size(); ++i) {
+        bounds[i] = random_bounds();
+        grid.update(i, bounds[i]);
+    }
+    // Move half of them, some across cells
+    for (uint32_t i = 0; i < bounds.size(); i += 2) {
+        bounds[i] = random_bounds();
+        grid.update(i, bounds[i]);
+    }
+    grid.remove(7);
+    grid.remove(7);
+    REQUIRE(grid.size() == bounds.size() - 1);
+    size_t mismatches = 0;
+    for (int query = 0; query < 50; ++query) {
+        valiant::AABB area = random_bounds();
+        area.max_x += 300;
+        area.max_y += 200;
+        std::vector<uint32_t> ids;
+        grid.query(area, ids);
+        std::sort(ids.begin(), ids.end());
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < bounds.size(); ++i) {
+            if (i != 7 && aabb_overlap(bounds[i], area)) {
+                expected.push_back(i);
+            }
+        }
+        if (ids != expected) {
+            ++mismatches;
+        }
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Spatial grid clear") {
+    valiant::SpatialGrid grid;
+    grid.update(0, {0, 0, 10, 10});
+    grid.update(1, {5000, 5000, 5010, 5010});
+    std::vector<uint32_t> ids;
+    // Areas covering more cells than exist visit the existing cells instead
+    grid.query({-1e6f, -1e6f, 1e6f, 1e6f}, ids);
+    REQUIRE(ids.size() == 2);
+    grid.clear();
+    REQUIRE(grid.size() == 0);
+    ids.clear();
+    grid.query({-1e6f, -1e6f, 1e6f, 1e6f}, ids);
+    REQUIRE(ids.empty());
+    // Ids can be placed again after a clear
+    grid.update(1, {0, 0, 10, 10});
+    grid.query({0, 0, 1, 1}, ids);
+    REQUIRE(ids == std::vector<uint32_t>{1});
+}
@@ -0,0 +1,57 @@
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+#include "../valiant/renderer.hpp"
+#include "../valiant/tag.hpp"
+
+TEST_CASE("Tag interning") {
+    valiant::Tag untagged;
+    REQUIRE(untagged.id() == 0);
+    REQUIRE(untagged.name() == valiant::UNTAGGED);
+    REQUIRE(untagged == valiant::Tag("untagged"));
+    valiant::Tag player("test_player");
+    size_t tag_count = valiant::TagRegistry::instance().size();
+    // Equal names share an id
+    REQUIRE(player == valiant::Tag(std::string("test_player")));
+    REQUIRE(valiant::TagRegistry::instance().size() == tag_count);
+    REQUIRE(player != valiant::Tag("test_enemy"));
+    REQUIRE(player.name() == "test_player");
+    valiant::Tag copy = player;
+    REQUIRE(copy == player);
+    REQUIRE(copy.name() == "test_player");
+}
+
+TEST_CASE("Renderer objects by tag") {
+    class Box : public valiant::Object {
+       public:
+        valiant::Tag next_tag;
+
+        void update() override { tag = next_tag; }
+    };
+    valiant::Renderer renderer(valiant::DISABLE);
+    std::vector<Box> boxes(6);
+    valiant::Tag red("red");
+    valiant::Tag blue("blue");
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        boxes[i].tag = i % 2 ? red : blue;
+        boxes[i].next_tag = boxes[i].tag;
+        renderer.add_object(boxes[i]);
+    }
+    renderer.run();
+    const std::vector<valiant::Object *> &red_boxes =
+        renderer.find_objects_with_tag(red);
+    REQUIRE(red_boxes.size() == 3);
+    REQUIRE(red_boxes[0] == &boxes[1]);
+    REQUIRE(red_boxes[2] == &boxes[5]);
+    REQUIRE(renderer.find_object_with_tag(blue) == &boxes[0]);
+    REQUIRE(renderer.find_object_with_tag(valiant::Tag("green")) == nullptr);
+    REQUIRE(renderer.find_objects_with_tag(valiant::Tag()).empty());
+    // Tags changed by updates and removed objects are seen after the frame
+    boxes[0].next_tag = red;
+    renderer.remove_object(boxes[5]);
+    renderer.step(1. / 60);
+    REQUIRE(renderer.find_objects_with_tag(red).size() == 3);
+    REQUIRE(renderer.find_object_with_tag(red) == &boxes[0]);
+    REQUIRE(renderer.find_objects_with_tag(blue).size() == 2);
+}
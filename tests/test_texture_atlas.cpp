@@ -0,0 +1,153 @@
+#include <SDL2/SDL.h>
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <vector>
+
+#include "../valiant/texture_atlas.hpp"
+
+bool regions_overlap(const valiant::AtlasRegion &region_1,
+                     const valiant::AtlasRegion &region_2) {
+    return region_1.page == region_2.page &&
+           SDL_HasIntersection(&region_1.rect, &region_2.rect);
+}
+
+TEST_CASE("Atlas packer regions") {
+    const int size = 256;
+    const int padding = 1;
+    valiant::AtlasPacker packer(size, padding);
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<int> length(1, 64);
+    std::vector<valiant::AtlasRegion> regions;
+    for (int i = 0; i < 200; ++i) {
+        int width = length(generator);
+        int height = length(generator);
+        valiant::AtlasRegion region;
+        REQUIRE(packer.pack(width, height, region));
+        REQUIRE(region.rect.w == width);
+        REQUIRE(region.rect.h == height);
+        regions.push_back(region);
+    }
+    // 200 regions averaging 32x32 do not fit on a single page
+    REQUIRE(packer.page_count() > 1);
+    size_t invalid_regions = 0;
+    for (size_t i = 0; i < regions.size(); ++i) {
+        const SDL_Rect &rect = regions[i].rect;
+        // Padding is kept from the page edges
+        if (regions[i].page < 0 || regions[i].page >= packer.page_count() ||
+            rect.x < padding || rect.y < padding ||
+            rect.x + rect.w + padding > size ||
+            rect.y + rect.h + padding > size) {
+            ++invalid_regions;
+        }
+        for (size_t j = i + 1; j < regions.size(); ++j) {
+            if (regions_overlap(regions[i], regions[j])) {
+                ++invalid_regions;
+            }
+        }
+    }
+    REQUIRE(invalid_regions == 0);
+}
+
+TEST_CASE("Atlas packer shelves") {
+    valiant::AtlasPacker packer(64, 0);
+    valiant::AtlasRegion region;
+    REQUIRE(packer.pack(32, 16, region));
+    REQUIRE(region.rect.x == 0);
+    REQUIRE(region.rect.y == 0);
+    // Shorter regions go next to taller ones on the same shelf
+    REQUIRE(packer.pack(32, 8, region));
+    REQUIRE(region.rect.x == 32);
+    REQUIRE(region.rect.y == 0);
+    // A full shelf starts a new one below it
+    REQUIRE(packer.pack(16, 16, region));
+    REQUIRE(region.rect.x == 0);
+    REQUIRE(region.rect.y == 16);
+    REQUIRE(packer.page_count() == 1);
+    // Too large or empty regions are rejected
+    REQUIRE(packer.pack(65, 1, region) == false);
+    REQUIRE(packer.pack(0, 1, region) == false);
+}
+
+TEST_CASE("Texture atlas surfaces") {
+    valiant::TextureAtlas atlas(128);
+    SDL_Surface *surface =
+        SDL_CreateRGBSurfaceWithFormat(0, 20, 10, 32, SDL_PIXELFORMAT_RGBA32);
+    valiant::AtlasRegion region;
+    REQUIRE(atlas.add(surface, region));
+    REQUIRE(region.page == 0);
+    REQUIRE(region.rect.w == 20);
+    REQUIRE(region.rect.h == 10);
+    REQUIRE(atlas.page_count() == 1);
+    SDL_FreeSurface(surface);
+    // Missing surfaces, or surfaces too large for a page, are not added
+    REQUIRE(atlas.add(nullptr, region) == false);
+    SDL_Surface *large_surface =
+        SDL_CreateRGBSurfaceWithFormat(0, 200, 10, 32, SDL_PIXELFORMAT_RGBA32);
+    REQUIRE(atlas.add(large_surface, region) == false);
+    SDL_FreeSurface(large_surface);
+    // Textures need a renderer
+    REQUIRE(atlas.texture(0, nullptr) == nullptr);
+    REQUIRE(atlas.texture(1, nullptr) == nullptr);
+    atlas.clear();
+    REQUIRE(atlas.page_count() == 0);
+}
+
+TEST_CASE("Texture atlas uploads added regions") {
+    SDL_Surface *target =
+        SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer *renderer = SDL_CreateSoftwareRenderer(target);
+    valiant::TextureAtlas atlas(128);
+    SDL_Surface *surface =
+        SDL_CreateRGBSurfaceWithFormat(0, 20, 10, 32, SDL_PIXELFORMAT_RGBA32);
+    valiant::AtlasRegion region;
+    REQUIRE(atlas.add(surface, region));
+    SDL_Texture *texture = atlas.texture(0, renderer);
+    REQUIRE(texture != nullptr);
+    REQUIRE(atlas.stats().textures_created == 1);
+    REQUIRE(atlas.stats().region_uploads == 0);
+    // Regions added later are copied into the same texture
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(atlas.add(surface, region));
+    }
+    REQUIRE(atlas.texture(0, renderer) == texture);
+    REQUIRE(atlas.stats().textures_created == 1);
+    REQUIRE(atlas.stats().region_uploads == 3);
+    REQUIRE(atlas.texture(0, renderer) == texture);
+    REQUIRE(atlas.stats().region_uploads == 3);
+    SDL_FreeSurface(surface);
+    atlas.clear();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+}
+
+TEST_CASE("Texture atlas reuses emptied pages") {
+    valiant::TextureAtlas atlas(64);
+    SDL_Surface *surface =
+        SDL_CreateRGBSurfaceWithFormat(0, 30, 30, 32, SDL_PIXELFORMAT_RGBA32);
+    // Four padded regions fill a page
+    valiant::AtlasRegion region;
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE(atlas.add(surface, region));
+        REQUIRE(region.page == i / 4);
+    }
+    REQUIRE(atlas.page_count() == 2);
+    // A page is only reset once every region on it is removed
+    for (int i = 0; i < 3; ++i) {
+        atlas.remove(0);
+    }
+    REQUIRE(atlas.stats().pages_reset == 0);
+    REQUIRE(atlas.add(surface, region));
+    REQUIRE(region.page == 2);
+    atlas.remove(0);
+    REQUIRE(atlas.stats().pages_reset == 1);
+    // Fills the shelf left on page 2, then all of page 0 again
+    int page_0_regions = 0;
+    for (int i = 0; i < 5; ++i) {
+        REQUIRE(atlas.add(surface, region));
+        page_0_regions += region.page == 0;
+    }
+    REQUIRE(page_0_regions == 4);
+    REQUIRE(atlas.page_count() == 3);
+    SDL_FreeSurface(surface);
+}
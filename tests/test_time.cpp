@@ -10,3 +10,20 @@ TEST_CASE("Time default values") {
     delta_time = time.delta_time;
     REQUIRE(delta_time == 1.5);
 }
+
+TEST_CASE("Time alpha") {
+    valiant::Time time(0.5);
+    double alpha = time.alpha;
+    REQUIRE(alpha == 0.);
+    time.set_alpha(0.25);
+    alpha = time.alpha;
+    REQUIRE(alpha == 0.25);
+    // Copies keep their own values
+    valiant::Time copy = time;
+    time.set(1.);
+    time.set_alpha(0.75);
+    double copy_delta_time = copy.delta_time;
+    double copy_alpha = copy.alpha;
+    REQUIRE(copy_delta_time == 0.5);
+    REQUIRE(copy_alpha == 0.25);
+}
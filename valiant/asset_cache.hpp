@@ -0,0 +1,369 @@
+#ifndef VALIANT_ASSET_CACHE_HPP
+#define VALIANT_ASSET_CACHE_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "error.hpp"
+#include "texture_atlas.hpp"
+
+namespace valiant {
+// Threads decoding images loaded in the background
+const size_t ASSET_LOADER_THREADS = 2;
+
+// Decoded image shared by every sprite loaded from the same path
+struct Image {
+    std::string path;
+    // 0 until the image has been decoded
+    int width;
+    int height;
+    // Being decoded in the background
+    bool loading;
+    // Set if decoding in the background failed, the renderer throws it as
+    // a ValiantError when a sprite of the image is drawn
+    std::string error;
+    // Freed once the image has been uploaded
+    SDL_Surface* surface;
+    // Own texture, null while the image is in the atlas
+    SDL_Texture* texture;
+    // Atlas page and region, page is -1 if the image is not in the atlas
+    int atlas_page;
+    SDL_Rect atlas_rect;
+
+    explicit Image(const std::string& new_path)
+        : path(new_path),
+          width(0),
+          height(0),
+          loading(false),
+          surface(nullptr),
+          texture(nullptr),
+          atlas_page(-1),
+          atlas_rect() {}
+
+    ~Image() {
+        SDL_FreeSurface(surface);
+        SDL_DestroyTexture(texture);
+    }
+
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    // Uncompressed size of the image
+    inline size_t bytes() const {
+        return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+    }
+
+    inline bool is_uploaded() const {
+        return texture != nullptr || atlas_page >= 0;
+    }
+};
+
+struct AssetCacheStats {
+    // Loads served from the cache and loads that decoded the file
+    size_t hits;
+    size_t misses;
+    // Images currently shared by at least one sprite and their size
+    size_t images;
+    size_t bytes_resident;
+};
+
+// Images keyed by path. An image is decoded once and uploaded once however
+// many sprites use it, and is freed with its last sprite. Images can be
+// decoded on loader threads, every other member is only used from the
+// thread that renders. The cache is destroyed at exit like any function
+// local static. Images and renderers outliving it, such as ones with static
+// storage, stop using it, sprites must not be loaded after that.
+class AssetCache {
+   public:
+    static AssetCache& instance() {
+        static AssetCache asset_cache;
+        return asset_cache;
+    }
+
+    // Set once the cache has been destroyed at exit
+    static bool is_destroyed() { return destroyed(); }
+
+    ~AssetCache() {
+        destroyed() = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& loader : loaders_) {
+            loader.join();
+        }
+        for (Decoded& decoded : decoded_) {
+            SDL_FreeSurface(decoded.surface);
+        }
+        for (Decoded& decoded : pending_uploads_) {
+            SDL_FreeSurface(decoded.surface);
+        }
+    }
+
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    // Decode the image at path, or share it if it is already loaded
+    std::shared_ptr<Image> load(const std::string& path) {
+        std::shared_ptr<Image> image = find(path);
+        if (image && !image->loading) {
+            return image;
+        }
+        // Images still being decoded in the background are decoded here
+        // instead, the background result is discarded
+        SDL_Surface* surface = IMG_Load(path.c_str());
+        if (!surface) {
+            // Error encountered when loading image
+            throw ValiantError(IMG_GetError());
+        }
+        if (!image) {
+            image = insert(path);
+        }
+        attach(*image, surface);
+        return image;
+    }
+
+    // Queue the image at path to be decoded on a loader thread, or share it
+    // if it is already loaded or loading. The image is attached and
+    // uploaded by process_uploads once decoded.
+    std::shared_ptr<Image> load_async(const std::string& path) {
+        std::shared_ptr<Image> image = find(path);
+        if (image) {
+            return image;
+        }
+        image = insert(path);
+        image->loading = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (loaders_.empty()) {
+                for (size_t i = 0; i < ASSET_LOADER_THREADS; ++i) {
+                    loaders_.emplace_back(&AssetCache::decode, this);
+                }
+            }
+            requests_.push_back({image, path});
+        }
+        wake_.notify_one();
+        return image;
+    }
+
+    // Attach images decoded in the background and upload at most
+    // max_uploads of them. Images packed into the atlas only copy their own
+    // region into the page texture. Returns the number of images uploaded.
+    size_t process_uploads(SDL_Renderer* renderer, bool use_atlas,
+                           size_t max_uploads) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_uploads_.insert(pending_uploads_.end(), decoded_.begin(),
+                                    decoded_.end());
+            decoded_.clear();
+        }
+        size_t uploads = 0;
+        while (uploads < max_uploads && !pending_uploads_.empty()) {
+            Decoded decoded = pending_uploads_.front();
+            pending_uploads_.pop_front();
+            std::shared_ptr<Image> image = decoded.image.lock();
+            if (!image || !image->loading) {
+                // Unused or already decoded on the render thread
+                SDL_FreeSurface(decoded.surface);
+                continue;
+            }
+            if (!decoded.surface) {
+                image->loading = false;
+                image->error = decoded.error;
+                continue;
+            }
+            attach(*image, decoded.surface);
+            upload(*image, renderer, use_atlas);
+            ++uploads;
+        }
+        return uploads;
+    }
+
+    // Images queued or being decoded on loader threads
+    size_t pending_loads() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return requests_.size() + decoding_;
+    }
+
+    // Images decoded but not yet processed by process_uploads
+    size_t pending_uploads() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return decoded_.size() + pending_uploads_.size();
+    }
+
+    // Create the texture of image, or pack it into the atlas. Images whose
+    // textures were released are decoded again first.
+    void upload(Image& image, SDL_Renderer* renderer, bool use_atlas) {
+        if (image.is_uploaded() || image.loading || !image.error.empty()) {
+            return;
+        }
+        if (!image.surface) {
+            image.surface = IMG_Load(image.path.c_str());
+            if (!image.surface) {
+                return;
+            }
+        }
+        AtlasRegion region;
+        if (use_atlas && atlas_.add(image.surface, region)) {
+            image.atlas_page = region.page;
+            image.atlas_rect = region.rect;
+        } else {
+            image.texture =
+                SDL_CreateTextureFromSurface(renderer, image.surface);
+            if (!image.texture) {
+                // Keep the surface to try again with a valid renderer
+                return;
+            }
+        }
+        SDL_FreeSurface(image.surface);
+        image.surface = nullptr;
+    }
+
+    // Destroy every texture before their renderer is destroyed. Images are
+    // decoded and uploaded again if they are drawn by another renderer.
+    void release_textures() {
+        for (auto& entry : images_) {
+            if (std::shared_ptr<Image> image = entry.second.lock()) {
+                SDL_DestroyTexture(image->texture);
+                image->texture = nullptr;
+                image->atlas_page = -1;
+            }
+        }
+        atlas_.clear();
+    }
+
+    inline TextureAtlas& atlas() { return atlas_; }
+
+    inline AssetCacheStats stats() const { return stats_; }
+
+    inline void reset_stats() {
+        stats_.hits = 0;
+        stats_.misses = 0;
+    }
+
+   private:
+    struct Request {
+        std::weak_ptr<Image> image;
+        std::string path;
+    };
+
+    struct Decoded {
+        std::weak_ptr<Image> image;
+        SDL_Surface* surface;
+        std::string error;
+    };
+
+    std::map<std::string, std::weak_ptr<Image>> images_;
+    TextureAtlas atlas_;
+    AssetCacheStats stats_;
+    // Loader threads and the queues shared with them, guarded by mutex_
+    std::vector<std::thread> loaders_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Request> requests_;
+    std::vector<Decoded> decoded_;
+    size_t decoding_;
+    bool stop_;
+    // Decoded images waiting for their upload, render thread only
+    std::deque<Decoded> pending_uploads_;
+
+    AssetCache() : stats_({0, 0, 0, 0}), decoding_(0), stop_(false) {}
+
+    std::shared_ptr<Image> find(const std::string& path) {
+        auto entry = images_.find(path);
+        if (entry != images_.end()) {
+            if (std::shared_ptr<Image> image = entry->second.lock()) {
+                ++stats_.hits;
+                return image;
+            }
+        }
+        ++stats_.misses;
+        return nullptr;
+    }
+
+    std::shared_ptr<Image> insert(const std::string& path) {
+        std::shared_ptr<Image> image(new Image(path), &AssetCache::release);
+        images_[path] = image;
+        ++stats_.images;
+        return image;
+    }
+
+    void attach(Image& image, SDL_Surface* surface) {
+        image.loading = false;
+        image.surface = surface;
+        image.width = surface->w;
+        image.height = surface->h;
+        stats_.bytes_resident += image.bytes();
+    }
+
+    // Loader thread
+    void decode() {
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock,
+                           [this]() { return stop_ || !requests_.empty(); });
+                if (stop_) {
+                    return;
+                }
+                request = requests_.front();
+                requests_.pop_front();
+                ++decoding_;
+            }
+            Decoded decoded = {request.image, nullptr, ""};
+            // Skip images no sprite uses anymore
+            if (!request.image.expired()) {
+                decoded.surface = IMG_Load(request.path.c_str());
+                if (!decoded.surface) {
+                    decoded.error = IMG_GetError();
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            decoded_.push_back(decoded);
+            --decoding_;
+        }
+    }
+
+    static bool& destroyed() {
+        // Trivially destructible, so still readable after the cache is gone
+        static bool flag = false;
+        return flag;
+    }
+
+    // Deleter of images
+    static void release(Image* image) {
+        if (is_destroyed()) {
+            delete image;
+        } else {
+            instance().evict(image);
+        }
+    }
+
+    void evict(Image* image) {
+        auto entry = images_.find(image->path);
+        if (entry != images_.end() && entry->second.expired()) {
+            images_.erase(entry);
+        }
+        --stats_.images;
+        stats_.bytes_resident -= image->bytes();
+        // Pages are reused once no image uses them
+        atlas_.remove(image->atlas_page);
+        delete image;
+    }
+};
+}  // namespace valiant
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef VALIANT_BOUNDS_HPP
+#define VALIANT_BOUNDS_HPP
+
+#include "collider.hpp"
+#include "object.hpp"
+#include "shape.hpp"
+#include "sprite_renderer.hpp"
+
+namespace valiant {
+// Size of an object or entity at position, from its sprite or else its
+// shape. Either can be null, the size is 0 without both.
+inline ObjectData get_drawn_data(const Vector3& position, const Sprite* sprite,
+                                 const Shape* shape) {
+    ObjectData object_data = {0, 0, position};
+    if (sprite) {
+        object_data.width = sprite->width;
+        object_data.height = sprite->height;
+    } else if (shape) {
+        object_data.width = shape->width;
+        object_data.height = shape->height;
+    }
+    return object_data;
+}
+
+// Bounds of an object centered on its position, independent of any camera
+inline AABB get_world_bounds(const ObjectData& object) {
+    float half_width = static_cast<float>(object.width) / 2;
+    float half_height = static_cast<float>(object.height) / 2;
+    return {object.position.x - half_width, object.position.y - half_height,
+            object.position.x + half_width, object.position.y + half_height};
+}
+}  // namespace valiant
+
+#endif
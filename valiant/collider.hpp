@@ -3,7 +3,7 @@
 
 #include <SDL2/SDL.h>
 
-#include <string>
+#include <cstdint>
 #include <vector>
 
 #include "object.hpp"
@@ -11,17 +11,52 @@
 namespace valiant {
 struct Collision {
     Transform transform;
-    std::string tag;
+    Tag tag;
 
     bool operator==(const Collision& collision) const {
         return (transform == collision.transform && tag == collision.tag);
     }
 };
 
+// Axis aligned bounding box in world units
+struct AABB {
+    float min_x;
+    float min_y;
+    float max_x;
+    float max_y;
+
+    inline bool is_empty() const { return !(min_x < max_x && min_y < max_y); }
+
+    bool operator==(const AABB& aabb) const {
+        return (min_x == aabb.min_x && min_y == aabb.min_y &&
+                max_x == aabb.max_x && max_y == aabb.max_y);
+    }
+};
+
+const uint8_t COLLIDER_LAYER_COUNT = 32;
+const uint32_t ALL_COLLIDER_LAYERS = 0xFFFFFFFF;
+
 struct ColliderComponent {
     bool enabled;
+    // Layer the collider belongs to, in [0, COLLIDER_LAYER_COUNT)
+    uint8_t layer;
+    // Bit n is set if the collider collides with colliders on layer n. Both
+    // colliders of a pair have to accept each other's layer.
+    uint32_t layer_mask;
+    // Static colliders never move. Their bounds are cached and only pairs
+    // with at least one non-static collider are tested.
+    bool is_static;
 
-    ColliderComponent() : enabled(true) {}
+    ColliderComponent()
+        : enabled(true),
+          layer(0),
+          layer_mask(ALL_COLLIDER_LAYERS),
+          is_static(false) {}
+
+    inline bool accepts(const ColliderComponent& collider) const {
+        return (layer_mask >> collider.layer) & 1 &&
+               (collider.layer_mask >> layer) & 1;
+    }
 };
 
 class Collider {
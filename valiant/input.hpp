@@ -5,59 +5,244 @@
 
 #include <SDL2/SDL.h>
 
+#include <bitset>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "error.hpp"
 
 namespace valiant {
-enum class EventType { KEYDOWN, KEY, KEYUP };
+// Key resolved once from its name, or built from an SDL scancode constant
+struct Key {
+    SDL_Scancode scancode;
 
-class Input {
+    constexpr Key(SDL_Scancode new_scancode = SDL_SCANCODE_UNKNOWN)
+        : scancode(new_scancode) {}
+
+    bool operator==(const Key &key) const { return scancode == key.scancode; }
+};
+
+// Handle of an action in the ActionMap
+struct Action {
+    size_t index;
+};
+
+// Keyboard snapshot shared by every object. The renderer feeds it every
+// event queued since the last frame, so keys pressed together or pressed
+// and released within one frame are all seen.
+class KeyboardState {
    public:
-    SDL_Event event;
+    static KeyboardState &instance() {
+        static KeyboardState keyboard_state;
+        return keyboard_state;
+    }
 
-    auto get_key_down(const std::string &key) const -> bool {
-        return query_key(key, EventType::KEYDOWN);
+    KeyboardState(const KeyboardState &) = delete;
+    KeyboardState &operator=(const KeyboardState &) = delete;
+
+    // Record a key event, other events are ignored
+    void process(const SDL_Event &event) {
+        if (event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) {
+            return;
+        }
+        size_t scancode = static_cast<size_t>(event.key.keysym.scancode);
+        if (scancode >= SDL_NUM_SCANCODES) {
+            return;
+        }
+        if (event.type == SDL_KEYUP) {
+            released_.set(scancode);
+            held_.reset(scancode);
+        } else if (event.key.repeat == 0) {
+            pressed_.set(scancode);
+            held_.set(scancode);
+        }
     }
 
-    auto get_key(const std::string &key) const -> bool {
-        return query_key(key, EventType::KEY);
+    // Forget keys pressed and released since the last update, held keys
+    // stay held
+    void clear_transitions() {
+        pressed_.reset();
+        released_.reset();
     }
 
-    auto get_key_up(const std::string &key) const -> bool {
-        return query_key(key, EventType::KEYUP);
+    void reset() {
+        clear_transitions();
+        held_.reset();
+    }
+
+    // Pressed since the last update
+    inline bool pressed(SDL_Scancode scancode) const {
+        return test(pressed_, scancode);
+    }
+
+    // Down now, or pressed and released since the last update
+    inline bool held(SDL_Scancode scancode) const {
+        return test(held_, scancode) || test(pressed_, scancode);
+    }
+
+    // Released since the last update
+    inline bool released(SDL_Scancode scancode) const {
+        return test(released_, scancode);
     }
 
    private:
-    auto query_key(std::string key, EventType event_type) const -> bool {
-        SDL_Keycode key_code = SDL_GetKeyFromName(key.c_str());
-        if (key_code != SDLK_UNKNOWN) {
-            bool condition;
-            switch (event_type) {
-                case EventType::KEYDOWN:
-                    condition =
-                        (event.type == SDL_KEYDOWN && event.key.repeat == 0);
-                    break;
-                case EventType::KEY:
-                    condition = (event.type == SDL_KEYDOWN);
-                    break;
-                case EventType::KEYUP:
-                    condition = (event.type == SDL_KEYUP &&
-                                 event.key.keysym.sym == key_code);
-                    break;
-                default:
-                    throw ValiantError(
-                        "Unrecognized event type (INTERNAL ERROR)");
+    std::bitset<SDL_NUM_SCANCODES> pressed_;
+    std::bitset<SDL_NUM_SCANCODES> held_;
+    std::bitset<SDL_NUM_SCANCODES> released_;
+
+    KeyboardState() {}
+
+    static inline bool test(const std::bitset<SDL_NUM_SCANCODES> &keys,
+                            SDL_Scancode scancode) {
+        size_t index = static_cast<size_t>(scancode);
+        return index < keys.size() && keys.test(index);
+    }
+};
+
+// Named actions bound to keys, shared by every object. Gameplay code asks
+// for actions so keys can be rebound without touching it.
+class ActionMap {
+   public:
+    static ActionMap &instance() {
+        static ActionMap action_map;
+        return action_map;
+    }
+
+    ActionMap(const ActionMap &) = delete;
+    ActionMap &operator=(const ActionMap &) = delete;
+
+    // Handle of action, which is created unbound if it does not exist
+    Action action(const std::string &name) {
+        auto entry = actions_.find(name);
+        if (entry != actions_.end()) {
+            return {entry->second};
+        }
+        size_t index = bindings_.size();
+        actions_[name] = index;
+        bindings_.emplace_back();
+        return {index};
+    }
+
+    // Add key to the keys triggering action
+    void bind(const std::string &name, Key key) {
+        bindings_[action(name).index].push_back(key);
+    }
+
+    void unbind(const std::string &name) {
+        bindings_[action(name).index].clear();
+    }
+
+    // Any bound key pressed
+    bool pressed(Action action) const {
+        const KeyboardState &keyboard = KeyboardState::instance();
+        for (Key key : bindings_[action.index]) {
+            if (keyboard.pressed(key.scancode)) {
+                return true;
             }
-            if (condition && event.key.keysym.sym == key_code) {
+        }
+        return false;
+    }
+
+    // Any bound key held
+    bool held(Action action) const {
+        const KeyboardState &keyboard = KeyboardState::instance();
+        for (Key key : bindings_[action.index]) {
+            if (keyboard.held(key.scancode)) {
                 return true;
             }
-            return false;
         }
-        throw ValiantError("Given key name parameter \"" + key +
-                           "\" was not recognized");
         return false;
     }
+
+    // A bound key released and none still held
+    bool released(Action action) const {
+        const KeyboardState &keyboard = KeyboardState::instance();
+        bool released = false;
+        for (Key key : bindings_[action.index]) {
+            if (keyboard.held(key.scancode)) {
+                return false;
+            }
+            if (keyboard.released(key.scancode)) {
+                released = true;
+            }
+        }
+        return released;
+    }
+
+   private:
+    std::map<std::string, size_t> actions_;
+    // Keys bound to each action, indexed by Action::index
+    std::vector<std::vector<Key>> bindings_;
+
+    ActionMap() {}
+};
+
+// Key and action queries answered from the shared KeyboardState. Resolve
+// names once with key and action, queries by name look the name up on
+// every call.
+class Input {
+   public:
+    // Key of an SDL key name. Names of scancodes resolve without a video
+    // subsystem, other key names need one to look up the current layout.
+    static Key key(const std::string &name) {
+        SDL_Scancode scancode = SDL_GetScancodeFromName(name.c_str());
+        if (scancode == SDL_SCANCODE_UNKNOWN) {
+            SDL_Keycode key_code = SDL_GetKeyFromName(name.c_str());
+            if (key_code != SDLK_UNKNOWN) {
+                scancode = SDL_GetScancodeFromKey(key_code);
+            }
+        }
+        if (scancode == SDL_SCANCODE_UNKNOWN) {
+            throw ValiantError("Given key name parameter \"" + name +
+                               "\" was not recognized");
+        }
+        return Key(scancode);
+    }
+
+    static Action action(const std::string &name) {
+        return ActionMap::instance().action(name);
+    }
+
+    static void bind(const std::string &action, Key key) {
+        ActionMap::instance().bind(action, key);
+    }
+
+    inline bool get_key_down(Key key) const {
+        return KeyboardState::instance().pressed(key.scancode);
+    }
+
+    inline bool get_key(Key key) const {
+        return KeyboardState::instance().held(key.scancode);
+    }
+
+    inline bool get_key_up(Key key) const {
+        return KeyboardState::instance().released(key.scancode);
+    }
+
+    inline bool get_action_down(Action action) const {
+        return ActionMap::instance().pressed(action);
+    }
+
+    inline bool get_action(Action action) const {
+        return ActionMap::instance().held(action);
+    }
+
+    inline bool get_action_up(Action action) const {
+        return ActionMap::instance().released(action);
+    }
+
+    auto get_key_down(const std::string &key) const -> bool {
+        return get_key_down(Input::key(key));
+    }
+
+    auto get_key(const std::string &key) const -> bool {
+        return get_key(Input::key(key));
+    }
+
+    auto get_key_up(const std::string &key) const -> bool {
+        return get_key_up(Input::key(key));
+    }
 };
 }  // namespace valiant
 
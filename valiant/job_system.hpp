@@ -0,0 +1,194 @@
+#ifndef VALIANT_JOB_SYSTEM_HPP
+#define VALIANT_JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace valiant {
+// Range function called with [begin, end) and the index of the calling worker
+typedef std::function<void(size_t, size_t, size_t)> RangeFunction;
+
+// Persistent pool of worker threads. The thread calling parallel_for takes
+// part in the work as worker 0, so a pool of one thread runs everything
+// inline. Chunks are dealt to workers as contiguous ranges, a worker that
+// runs out steals the back half of another worker's range.
+class JobSystem {
+   public:
+    explicit JobSystem(size_t thread_count = 0)
+        : ranges_(thread_count == 0 ? hardware_thread_count() : thread_count),
+          function_(nullptr),
+          count_(0),
+          grain_(1),
+          generation_(0),
+          busy_workers_(0),
+          stop_(false) {
+        for (size_t worker = 1; worker < ranges_.size(); ++worker) {
+            workers_.emplace_back(&JobSystem::work, this, worker);
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static inline size_t hardware_thread_count() {
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    // Number of threads work is split across, including the caller
+    inline size_t thread_count() const { return workers_.size() + 1; }
+
+    // Split [0, count) into chunks of at most grain indices and run them
+    // across all threads. Returns once every chunk has finished.
+    void parallel_for(size_t count, size_t grain,
+                      const RangeFunction& function) {
+        if (count == 0) {
+            return;
+        }
+        grain = std::max<size_t>(grain, 1);
+        if (workers_.empty() || count <= grain) {
+            function(0, count, 0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            function_ = &function;
+            count_ = count;
+            grain_ = grain;
+            size_t chunks = (count + grain - 1) / grain;
+            size_t threads = ranges_.size();
+            for (size_t worker = 0; worker < threads; ++worker) {
+                ranges_[worker].chunks.store(
+                    make_range(chunks * worker / threads,
+                               chunks * (worker + 1) / threads));
+            }
+            busy_workers_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        run_chunks(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return busy_workers_ == 0; });
+        function_ = nullptr;
+    }
+
+   private:
+    // Chunks [begin, end) left to a worker, packed as begin << 32 | end so
+    // the owner and thieves update them with a single compare and swap.
+    // Padded so workers do not share a cache line.
+    struct ChunkRange {
+        std::atomic<uint64_t> chunks;
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+
+        ChunkRange() : chunks(0) {}
+    };
+
+    std::vector<ChunkRange> ranges_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const RangeFunction* function_;
+    size_t count_;
+    size_t grain_;
+    uint64_t generation_;
+    size_t busy_workers_;
+    bool stop_;
+
+    static inline uint64_t make_range(uint64_t begin, uint64_t end) {
+        return begin << 32 | end;
+    }
+
+    void run_chunks(size_t worker) {
+        size_t chunk = 0;
+        while (pop_chunk(worker, chunk) || steal_chunks(worker, chunk)) {
+            size_t begin = chunk * grain_;
+            (*function_)(begin, std::min(begin + grain_, count_), worker);
+        }
+    }
+
+    // Take the first chunk of the worker's own range
+    bool pop_chunk(size_t worker, size_t& chunk) {
+        std::atomic<uint64_t>& chunks = ranges_[worker].chunks;
+        uint64_t range = chunks.load();
+        while (true) {
+            uint64_t begin = range >> 32;
+            uint64_t end = range & 0xFFFFFFFF;
+            if (begin >= end) {
+                return false;
+            }
+            if (chunks.compare_exchange_weak(range,
+                                             make_range(begin + 1, end))) {
+                chunk = static_cast<size_t>(begin);
+                return true;
+            }
+        }
+    }
+
+    // Take the back half of another worker's range, keep its first chunk
+    // in chunk and the rest as the worker's own range. Only called once the
+    // worker's own range is empty, so thieves never take from it meanwhile.
+    bool steal_chunks(size_t worker, size_t& chunk) {
+        for (size_t offset = 1; offset < ranges_.size(); ++offset) {
+            std::atomic<uint64_t>& chunks =
+                ranges_[(worker + offset) % ranges_.size()].chunks;
+            uint64_t range = chunks.load();
+            while (true) {
+                uint64_t begin = range >> 32;
+                uint64_t end = range & 0xFFFFFFFF;
+                if (begin >= end) {
+                    break;
+                }
+                uint64_t middle = begin + (end - begin) / 2;
+                if (chunks.compare_exchange_weak(range,
+                                                 make_range(begin, middle))) {
+                    chunk = static_cast<size_t>(middle);
+                    ranges_[worker].chunks.store(make_range(middle + 1, end));
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void work(size_t worker) {
+        uint64_t generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&]() {
+                    return stop_ || generation_ != generation;
+                });
+                if (stop_) {
+                    return;
+                }
+                generation = generation_;
+            }
+            run_chunks(worker);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_workers_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+};
+}  // namespace valiant
+
+#endif
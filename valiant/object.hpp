@@ -1,9 +1,8 @@
 #ifndef VALIANT_OBJECT_HPP
 #define VALIANT_OBJECT_HPP
 
-#include <string>
-
 #include "input.hpp"
+#include "tag.hpp"
 #include "time.hpp"
 
 namespace valiant {
@@ -21,6 +20,7 @@ struct Vector3 {
 };
 
 struct Transform {
+    // Objects with a larger z are drawn on top
     Vector3 position;
 
     bool operator==(const Transform& transform) const {
@@ -28,17 +28,40 @@ struct Transform {
     }
 };
 
-class Object {
+// Input and time of the current frame, shared by every object so that
+// starting a frame costs the same however many objects there are. Members
+// of a class template so that they can be defined in this header.
+template <typename T = void>
+class BasicContext {
+   public:
+    static Input input;
+    static Time time;
+};
+
+template <typename T>
+Input BasicContext<T>::input;
+
+template <typename T>
+Time BasicContext<T>::time;
+
+typedef BasicContext<> Context;
+
+class Object : public Context {
    public:
     Transform transform;
-    Input input;
-    Time time;
-    std::string tag = "untagged";
+    Tag tag;
     virtual void awake() {}
     virtual void start() {}
     virtual void update() {}
 };
 
+// Objects also deriving from ParallelUpdate declare that their update
+// method can run on any thread at the same time as those of other such
+// objects. It may only change the object itself and read input and time.
+// Objects still update in the order they were added, consecutive parallel
+// objects update together between the objects around them.
+class ParallelUpdate {};
+
 struct ObjectData {
     int width;
     int height;
@@ -0,0 +1,174 @@
+#ifndef VALIANT_OVERLAP_HPP
+#define VALIANT_OVERLAP_HPP
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "collider.hpp"
+
+namespace valiant {
+// Maximum number of boxes tested by a single kernel call, one bit each
+const size_t OVERLAP_BLOCK_SIZE = 32;
+
+// Tests one box against a packed block of boxes. The widest instruction set
+// enabled at compile time is used (AVX, then SSE2) with a scalar loop for
+// the remainder. Boxes with NaN bounds never overlap anything.
+class OverlapKernel {
+   public:
+    // Bit k of the result is set when box overlaps box k of the block.
+    // count must not exceed OVERLAP_BLOCK_SIZE.
+    static inline uint32_t mask(const AABB& box, const float* min_x,
+                                const float* min_y, const float* max_x,
+                                const float* max_y, size_t count) {
+        uint32_t result = 0;
+        size_t k = 0;
+#if defined(__AVX__)
+        const __m256 box_min_x_8 = _mm256_set1_ps(box.min_x);
+        const __m256 box_min_y_8 = _mm256_set1_ps(box.min_y);
+        const __m256 box_max_x_8 = _mm256_set1_ps(box.max_x);
+        const __m256 box_max_y_8 = _mm256_set1_ps(box.max_y);
+        for (; k + 8 <= count; k += 8) {
+            __m256 hit = _mm256_and_ps(
+                _mm256_cmp_ps(box_min_x_8, _mm256_loadu_ps(max_x + k),
+                              _CMP_LT_OQ),
+                _mm256_cmp_ps(_mm256_loadu_ps(min_x + k), box_max_x_8,
+                              _CMP_LT_OQ));
+            hit = _mm256_and_ps(
+                hit, _mm256_cmp_ps(box_min_y_8, _mm256_loadu_ps(max_y + k),
+                                   _CMP_LT_OQ));
+            hit = _mm256_and_ps(
+                hit, _mm256_cmp_ps(_mm256_loadu_ps(min_y + k), box_max_y_8,
+                                   _CMP_LT_OQ));
+            result |= static_cast<uint32_t>(_mm256_movemask_ps(hit)) << k;
+        }
+#endif
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+        const __m128 box_min_x_4 = _mm_set1_ps(box.min_x);
+        const __m128 box_min_y_4 = _mm_set1_ps(box.min_y);
+        const __m128 box_max_x_4 = _mm_set1_ps(box.max_x);
+        const __m128 box_max_y_4 = _mm_set1_ps(box.max_y);
+        for (; k + 4 <= count; k += 4) {
+            __m128 hit =
+                _mm_and_ps(_mm_cmplt_ps(box_min_x_4, _mm_loadu_ps(max_x + k)),
+                           _mm_cmplt_ps(_mm_loadu_ps(min_x + k), box_max_x_4));
+            hit = _mm_and_ps(
+                hit, _mm_cmplt_ps(box_min_y_4, _mm_loadu_ps(max_y + k)));
+            hit = _mm_and_ps(
+                hit, _mm_cmplt_ps(_mm_loadu_ps(min_y + k), box_max_y_4));
+            result |= static_cast<uint32_t>(_mm_movemask_ps(hit)) << k;
+        }
+#endif
+        if (k < count) {
+            result |= mask_scalar(box, min_x + k, min_y + k, max_x + k,
+                                  max_y + k, count - k)
+                      << k;
+        }
+        return result;
+    }
+
+    static inline uint32_t mask_scalar(const AABB& box, const float* min_x,
+                                       const float* min_y, const float* max_x,
+                                       const float* max_y, size_t count) {
+        uint32_t result = 0;
+        for (size_t k = 0; k < count; ++k) {
+            bool hit = box.min_x < max_x[k] && min_x[k] < box.max_x &&
+                       box.min_y < max_y[k] && min_y[k] < box.max_y;
+            result |= static_cast<uint32_t>(hit) << k;
+        }
+        return result;
+    }
+
+    // Index of the lowest set bit, mask must not be 0
+    static inline unsigned lowest_bit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+        unsigned bit = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+};
+
+// Per frame collider bounds stored as a structure of arrays so pair tests
+// walk contiguous memory
+struct ColliderBuffer {
+    std::vector<float> min_x;
+    std::vector<float> min_y;
+    std::vector<float> max_x;
+    std::vector<float> max_y;
+    // Enabled and non-empty. Stored as bytes as std::vector<bool> is packed
+    std::vector<uint8_t> enabled;
+
+    void resize(size_t size) {
+        min_x.resize(size);
+        min_y.resize(size);
+        max_x.resize(size);
+        max_y.resize(size);
+        enabled.resize(size);
+    }
+
+    inline size_t size() const { return min_x.size(); }
+
+    // Inactive bounds are stored as NaN so packed tests never report them
+    inline void set(size_t index, const AABB& aabb, bool is_enabled) {
+        bool is_active = is_enabled && !aabb.is_empty();
+        float nan = std::numeric_limits<float>::quiet_NaN();
+        min_x[index] = is_active ? aabb.min_x : nan;
+        min_y[index] = is_active ? aabb.min_y : nan;
+        max_x[index] = is_active ? aabb.max_x : nan;
+        max_y[index] = is_active ? aabb.max_y : nan;
+        enabled[index] = is_active;
+    }
+
+    // Integer rects are stored exactly as long as coordinates stay below 2^24
+    inline void set(size_t index, const SDL_Rect& rect, bool is_enabled) {
+        AABB aabb = {static_cast<float>(rect.x), static_cast<float>(rect.y),
+                     static_cast<float>(rect.x + rect.w),
+                     static_cast<float>(rect.y + rect.h)};
+        set(index, aabb, is_enabled);
+    }
+
+    inline AABB get(size_t index) const {
+        return {min_x[index], min_y[index], max_x[index], max_y[index]};
+    }
+
+    // Copy an entry from another buffer
+    inline void copy(size_t index, const ColliderBuffer& buffer,
+                     size_t source_index) {
+        min_x[index] = buffer.min_x[source_index];
+        min_y[index] = buffer.min_y[source_index];
+        max_x[index] = buffer.max_x[source_index];
+        max_y[index] = buffer.max_y[source_index];
+        enabled[index] = buffer.enabled[source_index];
+    }
+
+    // Equivalent to SDL_HasIntersection for enabled, non-empty bounds
+    inline bool overlaps(size_t i, size_t j) const {
+        return min_x[i] < max_x[j] && min_x[j] < max_x[i] &&
+               min_y[i] < max_y[j] && min_y[j] < max_y[i];
+    }
+
+    // Test box against up to OVERLAP_BLOCK_SIZE entries starting at start
+    inline uint32_t overlap_mask(const AABB& box, size_t start,
+                                 size_t count) const {
+        return OverlapKernel::mask(box, &min_x[start], &min_y[start],
+                                   &max_x[start], &max_y[start], count);
+    }
+};
+}  // namespace valiant
+
+#endif
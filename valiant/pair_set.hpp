@@ -0,0 +1,113 @@
+#ifndef VALIANT_PAIR_SET_HPP
+#define VALIANT_PAIR_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace valiant {
+const uint64_t PAIR_SET_EMPTY_KEY = ~static_cast<uint64_t>(0);
+const size_t PAIR_SET_MINIMUM_CAPACITY = 16;
+
+// Open addressing hash set of unordered id pairs. Memory grows with the
+// number of stored pairs rather than with the number of ids.
+class PairSet {
+   public:
+    PairSet() {}
+
+    // Pack two ids into a key whose ordering matches (lower, higher) ordering
+    static inline uint64_t make_key(uint32_t id_1, uint32_t id_2) {
+        return id_1 < id_2 ? (static_cast<uint64_t>(id_1) << 32) | id_2
+                           : (static_cast<uint64_t>(id_2) << 32) | id_1;
+    }
+
+    static inline uint32_t first_id(uint64_t key) {
+        return static_cast<uint32_t>(key >> 32);
+    }
+
+    static inline uint32_t second_id(uint64_t key) {
+        return static_cast<uint32_t>(key);
+    }
+
+    // Returns false if the key was already present
+    bool insert(uint64_t key) {
+        if ((keys_.size() + 1) * 4 > slots_.size() * 3) {
+            // Keep load factor at or below 0.75
+            grow();
+        }
+        size_t slot = find_slot(key);
+        if (slots_[slot] == key) {
+            return false;
+        }
+        slots_[slot] = key;
+        keys_.push_back(key);
+        return true;
+    }
+
+    bool contains(uint64_t key) const {
+        if (keys_.empty()) {
+            return false;
+        }
+        return slots_[find_slot(key)] == key;
+    }
+
+    // Only touches occupied slots so clearing costs O(size). Keys are removed
+    // in reverse insertion order so every probe chain is still intact when
+    // its key is looked up.
+    void clear() {
+        for (auto it = keys_.rbegin(); it != keys_.rend(); ++it) {
+            slots_[find_slot(*it)] = PAIR_SET_EMPTY_KEY;
+        }
+        keys_.clear();
+    }
+
+    void swap(PairSet& pair_set) {
+        slots_.swap(pair_set.slots_);
+        keys_.swap(pair_set.keys_);
+    }
+
+    inline size_t size() const { return keys_.size(); }
+
+    inline bool empty() const { return keys_.empty(); }
+
+    inline size_t capacity() const { return slots_.size(); }
+
+    // Keys in insertion order
+    inline const std::vector<uint64_t>& keys() const { return keys_; }
+
+   private:
+    std::vector<uint64_t> slots_;
+    std::vector<uint64_t> keys_;
+
+    static inline uint64_t hash(uint64_t key) {
+        // SplitMix64 finalizer
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return key;
+    }
+
+    // Linear probe for the slot holding key or the first empty slot
+    size_t find_slot(uint64_t key) const {
+        size_t mask = slots_.size() - 1;
+        size_t slot = static_cast<size_t>(hash(key)) & mask;
+        while (slots_[slot] != key && slots_[slot] != PAIR_SET_EMPTY_KEY) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void grow() {
+        size_t capacity =
+            slots_.empty() ? PAIR_SET_MINIMUM_CAPACITY : slots_.size() * 2;
+        slots_.assign(capacity, PAIR_SET_EMPTY_KEY);
+        for (uint64_t key : keys_) {
+            slots_[find_slot(key)] = key;
+        }
+    }
+};
+}  // namespace valiant
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef VALIANT_REGISTRY_HPP
+#define VALIANT_REGISTRY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "error.hpp"
+
+namespace valiant {
+// Marks entity indices without a component in a pool
+const uint32_t INVALID_ENTITY_INDEX = 0xFFFFFFFF;
+
+// Handle of an entity. The version tells apart entities reusing the index
+// of a destroyed one.
+struct Entity {
+    uint32_t index;
+    uint32_t version;
+
+    bool operator==(const Entity& entity) const {
+        return index == entity.index && version == entity.version;
+    }
+
+    bool operator!=(const Entity& entity) const { return !(*this == entity); }
+
+    bool operator<(const Entity& entity) const {
+        return index != entity.index ? index < entity.index
+                                     : version < entity.version;
+    }
+};
+
+class ComponentPoolBase {
+   public:
+    virtual ~ComponentPoolBase() {}
+
+    virtual bool contains(uint32_t index) const = 0;
+
+    virtual void remove(uint32_t index) = 0;
+};
+
+// Sparse set of components. Components are packed in a dense array in no
+// particular order, the sparse array maps entity indices into it.
+template <typename T>
+class ComponentPool : public ComponentPoolBase {
+   public:
+    // Add the component of the entity at index, or replace it
+    T& add(uint32_t index, const T& component) {
+        if (contains(index)) {
+            T& existing = components_[sparse_[index]];
+            existing = component;
+            return existing;
+        }
+        if (index >= sparse_.size()) {
+            sparse_.resize(index + 1, INVALID_ENTITY_INDEX);
+        }
+        sparse_[index] = static_cast<uint32_t>(dense_.size());
+        dense_.push_back(index);
+        components_.push_back(component);
+        return components_.back();
+    }
+
+    // Move the last component into the hole, so the pool stays packed
+    void remove(uint32_t index) override {
+        if (!contains(index)) {
+            return;
+        }
+        uint32_t position = sparse_[index];
+        uint32_t last = dense_.back();
+        if (position + 1 != dense_.size()) {
+            dense_[position] = last;
+            components_[position] = std::move(components_.back());
+            sparse_[last] = position;
+        }
+        dense_.pop_back();
+        components_.pop_back();
+        sparse_[index] = INVALID_ENTITY_INDEX;
+    }
+
+    inline bool contains(uint32_t index) const override {
+        return index < sparse_.size() && sparse_[index] != INVALID_ENTITY_INDEX;
+    }
+
+    // The entity at index must have a component
+    inline T& get(uint32_t index) { return components_[sparse_[index]]; }
+
+    inline size_t size() const { return dense_.size(); }
+
+    // Entity index of each component, in the order of components
+    inline const std::vector<uint32_t>& indices() const { return dense_; }
+
+    inline std::vector<T>& components() { return components_; }
+
+   private:
+    std::vector<uint32_t> sparse_;
+    std::vector<uint32_t> dense_;
+    std::vector<T> components_;
+};
+
+inline size_t next_component_type() {
+    static size_t next_type = 0;
+    return next_type++;
+}
+
+// Index of the pool of T in a registry, assigned on first use
+template <typename T>
+inline size_t component_type() {
+    static size_t type = next_component_type();
+    return type;
+}
+
+// Entities and their components, stored by component type in sparse sets so
+// systems iterate packed arrays instead of objects scattered on the heap.
+// Any copyable type can be a component.
+class Registry {
+   public:
+    Registry() : size_(0) {}
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    Entity create() {
+        ++size_;
+        if (!free_indices_.empty()) {
+            uint32_t index = free_indices_.back();
+            free_indices_.pop_back();
+            return {index, versions_[index]};
+        }
+        versions_.push_back(0);
+        return {static_cast<uint32_t>(versions_.size() - 1), 0};
+    }
+
+    // Remove entity and its components. Its handle becomes invalid.
+    void destroy(Entity entity) {
+        check(entity);
+        for (std::unique_ptr<ComponentPoolBase>& pool : pools_) {
+            if (pool) {
+                pool->remove(entity.index);
+            }
+        }
+        ++versions_[entity.index];
+        free_indices_.push_back(entity.index);
+        --size_;
+    }
+
+    inline bool valid(Entity entity) const {
+        return entity.index < versions_.size() &&
+               versions_[entity.index] == entity.version;
+    }
+
+    // Number of entities alive
+    inline size_t size() const { return size_; }
+
+    template <typename T>
+    T& add(Entity entity, const T& component = T()) {
+        check(entity);
+        return pool<T>().add(entity.index, component);
+    }
+
+    template <typename T>
+    void remove(Entity entity) {
+        check(entity);
+        pool<T>().remove(entity.index);
+    }
+
+    template <typename T>
+    bool has(Entity entity) const {
+        size_t type = component_type<T>();
+        return valid(entity) && type < pools_.size() && pools_[type] &&
+               pools_[type]->contains(entity.index);
+    }
+
+    template <typename T>
+    T& get(Entity entity) {
+        if (!has<T>(entity)) {
+            throw ValiantError("Entity " + std::to_string(entity.index) +
+                               " has no such component");
+        }
+        return pool<T>().get(entity.index);
+    }
+
+    template <typename T>
+    ComponentPool<T>& pool() {
+        size_t type = component_type<T>();
+        if (type >= pools_.size()) {
+            pools_.resize(type + 1);
+        }
+        if (!pools_[type]) {
+            pools_[type].reset(new ComponentPool<T>());
+        }
+        return static_cast<ComponentPool<T>&>(*pools_[type]);
+    }
+
+    // Call function(entity, T&, Others&...) for every entity having all the
+    // components. Walks the components of T in order, so T should be the
+    // rarest of them. Components of these types must not be added or
+    // removed by function.
+    template <typename T, typename... Others, typename F>
+    void each(F function) {
+        each_in(function, 0, pool<T>().size(), pool<T>(), pool<Others>()...);
+    }
+
+    // Like each, limited to the components of T in [begin, end). Disjoint
+    // ranges can be walked from several threads once the pools exist.
+    template <typename T, typename... Others, typename F>
+    void each(size_t begin, size_t end, F function) {
+        each_in(function, begin, std::min(end, pool<T>().size()), pool<T>(),
+                pool<Others>()...);
+    }
+
+    // Create the pools of Ts that do not exist yet
+    template <typename... Ts>
+    void prepare() {
+        int pools[] = {0, (pool<Ts>(), 0)...};
+        (void)pools;
+    }
+
+   private:
+    std::vector<uint32_t> versions_;
+    std::vector<uint32_t> free_indices_;
+    // Indexed by component_type
+    std::vector<std::unique_ptr<ComponentPoolBase>> pools_;
+    size_t size_;
+
+    inline void check(Entity entity) const {
+        if (!valid(entity)) {
+            throw ValiantError("Invalid entity: " +
+                               std::to_string(entity.index));
+        }
+    }
+
+    template <typename F, typename T, typename... Others>
+    void each_in(F& function, size_t begin, size_t end,
+                 ComponentPool<T>& first, ComponentPool<Others>&... others) {
+        const std::vector<uint32_t>& indices = first.indices();
+        std::vector<T>& components = first.components();
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t index = indices[i];
+            if (contains_all(index, others...)) {
+                function(Entity{index, versions_[index]}, components[i],
+                         others.get(index)...);
+            }
+        }
+    }
+
+    static inline bool contains_all(uint32_t) { return true; }
+
+    template <typename P, typename... Pools>
+    static inline bool contains_all(uint32_t index, const P& pool,
+                                    const Pools&... pools) {
+        return pool.contains(index) && contains_all(index, pools...);
+    }
+};
+}  // namespace valiant
+
+#endif
@@ -6,17 +6,32 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "bounds.hpp"
 #include "camera.hpp"
 #include "collider.hpp"
 #include "color.hpp"
 #include "error.hpp"
+#include "job_system.hpp"
 #include "object.hpp"
+#include "overlap.hpp"
+#include "pair_set.hpp"
+#include "registry.hpp"
 #include "shape.hpp"
+#include "spatial_grid.hpp"
 #include "sprite_renderer.hpp"
+#include "texture_atlas.hpp"
 #include "time.hpp"
 
 namespace valiant {
@@ -28,28 +43,76 @@ const int LOGICAL_WINDOW_WIDTH = 1920;
 const int LOGICAL_WINDOW_HEIGHT = 1080;
 
 const Color DEFAULT_BACKGROUND_COLOR = {0, 0, 0, 255};
+// Transparent, sprites are not drawn until their image is uploaded
+const Color DEFAULT_PLACEHOLDER_COLOR = {0, 0, 0, 0};
+// Images loaded in the background uploaded per frame
+const size_t ASYNC_UPLOADS_PER_FRAME = 8;
+// Objects or entities handed to an update thread at a time
+const size_t PARALLEL_UPDATE_GRAIN = 1024;
+// Fixed steps run by a single frame at most, time beyond them is dropped
+const size_t MAX_FIXED_STEPS_PER_FRAME = 5;
+// Logical pixels around the window still treated as visible, covers the
+// rounding of object positions to pixels
+const int CULLING_MARGIN = 2;
 
 typedef enum : uint_fast8_t {
     ENABLE = (1 << 0),
     DISABLE = (1 << 1),
     FULLSCREEN = (1 << 2),
-    VSYNC = (1 << 3)
+    VSYNC = (1 << 3),
+    // No window, frames are drawn to an offscreen surface by the software
+    // renderer
+    HEADLESS = (1 << 4)
 } RenderFlags;
 
+// Components of an object, resolved once when it is added so that frames
+// never need RTTI. Components an object does not have are null.
+struct ObjectComponents {
+    Object* object;
+    SpriteRenderer* sprite_renderer;
+    Rectangle* rectangle;
+    Collider* collider;
+    ParallelUpdate* parallel_update;
+};
+
+// Upcast when T is known to have component C, otherwise check at runtime
+template <typename C, typename T>
+inline C* get_component(T* object, std::true_type) {
+    return object;
+}
+
+template <typename C, typename T>
+inline C* get_component(T* object, std::false_type) {
+    return dynamic_cast<C*>(object);
+}
+
+template <typename C, typename T>
+inline C* get_component(T* object) {
+    return get_component<C>(object, std::is_base_of<C, T>());
+}
+
+template <typename T>
+inline ObjectComponents get_object_components(T& object) {
+    return {&object, get_component<SpriteRenderer>(&object),
+            get_component<Rectangle>(&object),
+            get_component<Collider>(&object),
+            get_component<ParallelUpdate>(&object)};
+}
+
 class ObjectManager {
    public:
     static ObjectData get_object_data(Object* object) {
-        // Assume width and height as 0
-        ObjectData object_data = {0, 0, object->transform.position};
-        if (SpriteRenderer* sprite_renderer =
-                dynamic_cast<SpriteRenderer*>(object)) {
-            object_data.width = sprite_renderer->sprite_renderer.sprite.width;
-            object_data.height = sprite_renderer->sprite_renderer.sprite.height;
-        } else if (Rectangle* rectangle = dynamic_cast<Rectangle*>(object)) {
-            object_data.width = rectangle->shape.width;
-            object_data.height = rectangle->shape.height;
-        }
-        return object_data;
+        return get_object_data(get_object_components(*object));
+    }
+
+    static inline ObjectData get_object_data(
+        const ObjectComponents& components) {
+        return get_drawn_data(
+            components.object->transform.position,
+            components.sprite_renderer
+                ? &components.sprite_renderer->sprite_renderer.sprite
+                : nullptr,
+            components.rectangle ? &components.rectangle->shape : nullptr);
     }
 
     static SDL_Rect get_object_camera_position(ObjectData object,
@@ -71,75 +134,198 @@ class ObjectManager {
                                  camera.position.y - (height / 2));
         return {x, y, width, height};
     }
+
+    // Area of the world shown by camera, the inverse of
+    // get_object_camera_position over the logical window
+    static AABB get_camera_world_bounds(CameraData camera) {
+        if (camera.size <= 0) {
+            // Invalid camera size
+            throw ValiantError("Invalid camera size: " +
+                               std::to_string(camera.size));
+        }
+        float half_width =
+            static_cast<float>(LOGICAL_WINDOW_WIDTH / 2 + CULLING_MARGIN);
+        float half_height =
+            static_cast<float>(LOGICAL_WINDOW_HEIGHT / 2 + CULLING_MARGIN);
+        return {(camera.position.x - half_width) * camera.size,
+                (camera.position.y - half_height) * camera.size,
+                (camera.position.x + half_width) * camera.size,
+                (camera.position.y + half_height) * camera.size};
+    }
+
+    // Bounds of an object centered on its position, independent of any camera
+    static AABB get_object_world_bounds(ObjectData object) {
+        return get_world_bounds(object);
+    }
 };
 
+// Number of colliders handed to a worker at a time
+const size_t BRUTE_FORCE_GRAIN = 16;
+const size_t SWEEP_GRAIN = 512;
+
+// Broad phase used to find candidate collider pairs before narrow phase
+enum class BroadPhase { BRUTE_FORCE, SWEEP_AND_PRUNE };
+
+// Space collider bounds are computed in. SCREEN projects colliders through
+// the camera onto integer rects, WORLD uses float bounds around
+// Transform::position and does not depend on the camera.
+enum class CollisionSpace { SCREEN, WORLD };
+
 class CollisionManager : public ObjectManager {
    public:
-    CollisionManager() {}
+    CollisionManager()
+        : next_collider_id_(0),
+          broad_phase_(BroadPhase::SWEEP_AND_PRUNE),
+          thread_count_(1),
+          static_space_(CollisionSpace::SCREEN),
+          static_camera_({0, {0, 0, 0}}),
+          statics_dirty_(true),
+          statics_moved_(false),
+          static_builds_(0) {}
 
+    // The copy creates its own worker threads on first use
     CollisionManager(const CollisionManager& collision_manager)
         : collider_objects_(collision_manager.collider_objects_),
-          collision_matrix_(collision_manager.collision_matrix_) {}
+          colliders_(collision_manager.colliders_),
+          collider_ids_(collision_manager.collider_ids_),
+          next_collider_id_(collision_manager.next_collider_id_),
+          broad_phase_(collision_manager.broad_phase_),
+          thread_count_(collision_manager.thread_count_),
+          contacts_(collision_manager.contacts_),
+          static_space_(collision_manager.static_space_),
+          static_camera_(collision_manager.static_camera_),
+          statics_dirty_(true),
+          statics_moved_(false),
+          static_builds_(0) {}
 
+    // Collide camera projected screen rects. When the camera moves, cached
+    // static colliders are projected again in place. Only changing the
+    // camera size rebuilds them.
     void process_collisions(CameraData camera) {
-        for (size_t i = 0; i < collider_objects_.size(); ++i) {
-            CollisionData collision_1(collider_objects_[i], camera);
-            for (size_t j = i + 1; j < collider_objects_.size(); ++j) {
-                CollisionData collision_2(collider_objects_[j], camera);
-                if ((!collision_1.collider->collider.enabled ||
-                     !collision_2.collider->collider.enabled) ||
-                    (!is_colliding(collision_1.rect, collision_2.rect))) {
-                    if (collision_matrix_[i][j]) {
-                        // Object at i and j were previously colliding. Execute
-                        // exit collision method
-                        collision_1.collider->on_collision_exit(
-                            get_collision_from_object(collision_2.object));
-                        collision_2.collider->on_collision_exit(
-                            get_collision_from_object(collision_1.object));
-                    }
-                    collision_matrix_[i][j] = false;
-                } else {
-                    // A valid collision has been detected
-                    if (collision_matrix_[i][j]) {
-                        // Object at i and j previous collided before and
-                        // are right colliding right now
-                        collision_1.collider->on_collision_stay(
-                            get_collision_from_object(collision_2.object));
-                        collision_2.collider->on_collision_stay(
-                            get_collision_from_object(collision_1.object));
-                    } else {
-                        // Object at i and j were not colliding previously,
-                        // but are colliding right now
-                        collision_1.collider->on_collision_enter(
-                            get_collision_from_object(collision_2.object));
-                        collision_2.collider->on_collision_enter(
-                            get_collision_from_object(collision_1.object));
-                        collision_matrix_[i][j] = true;
-                    }
-                }
-            }
+        if (static_space_ != CollisionSpace::SCREEN ||
+            static_camera_.size != camera.size) {
+            static_space_ = CollisionSpace::SCREEN;
+            statics_dirty_ = true;
+        } else if (!(static_camera_.position == camera.position)) {
+            statics_moved_ = true;
+        }
+        static_camera_ = camera;
+        collide([this, &camera](size_t i) {
+            return get_object_camera_position(
+                get_object_data(collider_objects_[i]), camera);
+        });
+    }
+
+    // Collide world space bounds, no camera required
+    void process_collisions() {
+        if (static_space_ != CollisionSpace::WORLD) {
+            static_space_ = CollisionSpace::WORLD;
+            statics_dirty_ = true;
         }
+        collide([this](size_t i) {
+            return get_object_world_bounds(
+                get_object_data(collider_objects_[i]));
+        });
     }
 
+    // Static colliders are rebuilt when one is added, removed or has its
+    // component changed. Call this after moving or resizing one.
+    inline void invalidate_static_colliders() { statics_dirty_ = true; }
+
+    // Number of times static colliders were rebuilt
+    inline size_t static_builds() const { return static_builds_; }
+
     static bool is_colliding(SDL_Rect& object_1, SDL_Rect& object_2) {
         return SDL_HasIntersection(&object_1, &object_2);
     }
 
+    static bool is_colliding(const AABB& object_1, const AABB& object_2) {
+        return !object_1.is_empty() && !object_2.is_empty() &&
+               object_1.min_x < object_2.max_x &&
+               object_2.min_x < object_1.max_x &&
+               object_1.min_y < object_2.max_y &&
+               object_2.min_y < object_1.max_y;
+    }
+
     static inline Collision get_collision_from_object(Object* object) {
         return {object->transform, object->tag};
     }
 
+    // Register colliders of objects. Can be called between frames to add
+    // colliders, existing ones keep their contacts.
     void fill_collider_objects(const std::vector<Object*>& objects) {
         for (auto object : objects) {
-            Collider* collider_object = dynamic_cast<Collider*>(object);
-            if (collider_object) {
-                collider_objects_.push_back(object);
+            add_collider_object(get_object_components(*object));
+        }
+    }
+
+    // Register colliders among objects with already resolved components
+    void fill_collider_components(
+        const std::vector<ObjectComponents>& objects) {
+        for (const ObjectComponents& components : objects) {
+            add_collider_object(components);
+        }
+    }
+
+    // Unregister colliders of objects between frames. Exit callbacks for
+    // their current contacts are dispatched first.
+    void remove_collider_objects(const std::vector<Object*>& objects) {
+        std::vector<Object*> removed(objects);
+        std::sort(removed.begin(), removed.end());
+        const size_t removed_index = std::numeric_limits<size_t>::max();
+        std::vector<size_t> remap(colliders_.size());
+        size_t size = 0;
+        for (size_t i = 0; i < colliders_.size(); ++i) {
+            if (std::binary_search(removed.begin(), removed.end(),
+                                   collider_objects_[i].object)) {
+                remap[i] = removed_index;
+                statics_dirty_ |= colliders_[i]->collider.is_static;
+            } else {
+                remap[i] = size++;
             }
         }
-        // Initialize collision matrix
-        for (size_t i = 0; i < collider_objects_.size(); ++i) {
-            std::vector<bool> row(collider_objects_.size(), false);
-            collision_matrix_.push_back(row);
+        if (size == colliders_.size()) {
+            return;
+        }
+        // previous_contacts_ is only needed while contacts are updated, so
+        // it holds the contacts that are kept
+        events_.clear();
+        previous_contacts_.clear();
+        for (uint64_t key : contacts_.keys()) {
+            if (remap[collider_index(PairSet::first_id(key))] ==
+                    removed_index ||
+                remap[collider_index(PairSet::second_id(key))] ==
+                    removed_index) {
+                events_.push_back({key, CollisionEventType::EXIT});
+            } else {
+                previous_contacts_.insert(key);
+            }
+        }
+        contacts_.swap(previous_contacts_);
+        std::sort(events_.begin(), events_.end());
+        dispatch_events();
+        // Compact in place so ids stay sorted
+        for (size_t i = 0; i < colliders_.size(); ++i) {
+            if (remap[i] != removed_index) {
+                collider_objects_[remap[i]] = collider_objects_[i];
+                colliders_[remap[i]] = colliders_[i];
+                collider_ids_[remap[i]] = collider_ids_[i];
+                if (i < static_states_.size()) {
+                    static_states_[remap[i]] = static_states_[i];
+                }
+            }
+        }
+        collider_objects_.resize(size);
+        colliders_.resize(size);
+        collider_ids_.resize(size);
+        static_states_.resize(std::min(static_states_.size(), size));
+        remap_indices(remap, removed_index, dynamic_indices_);
+        if (!statics_dirty_) {
+            // Only indices of static colliders moved
+            remap_indices(remap, removed_index, static_indices_);
+            for (size_t& index : static_order_) {
+                index = remap[index];
+            }
         }
     }
 
@@ -147,34 +333,608 @@ class CollisionManager : public ObjectManager {
         return collider_objects_.size();
     }
 
+    // Number of collider pairs that collided in the last processed frame
+    inline size_t contacts_size() const { return contacts_.size(); }
+
+    inline void set_broad_phase(BroadPhase broad_phase) {
+        broad_phase_ = broad_phase;
+    }
+
+    inline BroadPhase broad_phase() const { return broad_phase_; }
+
+    // Split pair detection across thread_count threads, 0 uses one thread
+    // per hardware thread. Callbacks always run on the calling thread.
+    void set_thread_count(size_t thread_count) {
+        if (thread_count == 0) {
+            thread_count =
+                std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        if (thread_count != thread_count_) {
+            thread_count_ = thread_count;
+            job_system_.reset();
+        }
+    }
+
+    inline size_t thread_count() const { return thread_count_; }
+
    private:
-    std::vector<Object*> collider_objects_;
-    std::vector<std::vector<bool>> collision_matrix_;
-
-    struct CollisionData {
-        Object* object;
-        Collider* collider;
-        SDL_Rect rect;
-
-        CollisionData(Object* new_object, CameraData camera)
-            : object(new_object),
-              collider(dynamic_cast<Collider*>(new_object)),
-              rect(get_object_camera_position(get_object_data(new_object),
-                                              camera)) {}
+    // Indices of two colliding colliders, in no particular order
+    typedef std::pair<size_t, size_t> ColliderPair;
+
+    enum class CollisionEventType { ENTER, STAY, EXIT };
+
+    // Where each layer starts and ends in a packed buffer, and the layers
+    // its colliders accept
+    struct LayerRanges {
+        size_t begin[COLLIDER_LAYER_COUNT];
+        size_t end[COLLIDER_LAYER_COUNT];
+        uint32_t mask[COLLIDER_LAYER_COUNT];
     };
+
+    // Colliders [begin, end) of sorted_ tested against [target_begin,
+    // target_end) of sorted_ or static_sorted_
+    struct LayerTask {
+        size_t begin;
+        size_t end;
+        size_t target_begin;
+        size_t target_end;
+        // Target range is the collider's own layer
+        bool same_layer;
+        // Skip targets starting at the same x as the collider
+        bool after_ties;
+        // Target range holds static colliders
+        bool static_target;
+    };
+
+    struct TaskChunk {
+        size_t task;
+        size_t begin;
+        size_t end;
+    };
+
+    struct CollisionEvent {
+        uint64_t key;
+        CollisionEventType type;
+
+        bool operator<(const CollisionEvent& event) const {
+            return key < event.key;
+        }
+    };
+
+    std::vector<ObjectComponents> collider_objects_;
+    // Collider component of each object
+    std::vector<Collider*> colliders_;
+    // Stable id of each collider, sorted in ascending order
+    std::vector<uint32_t> collider_ids_;
+    uint32_t next_collider_id_;
+    BroadPhase broad_phase_;
+    size_t thread_count_;
+    std::unique_ptr<JobSystem> job_system_;
+    // Pairs colliding in the current and previous frame
+    PairSet contacts_;
+    PairSet previous_contacts_;
+    // Scratch storage reused across frames
+    ColliderBuffer buffer_;
+    ColliderBuffer sorted_;
+    std::vector<size_t> sweep_order_;
+    LayerRanges layers_;
+    // Static colliders packed by layer and sorted along the x axis. Rebuilt
+    // only when statics_dirty_ is set, projected again when statics_moved_
+    // is set.
+    CollisionSpace static_space_;
+    CameraData static_camera_;
+    bool statics_dirty_;
+    bool statics_moved_;
+    size_t static_builds_;
+    // Static state of each collider when statics were last built
+    std::vector<uint64_t> static_states_;
+    std::vector<size_t> dynamic_indices_;
+    std::vector<size_t> static_indices_;
+    std::vector<size_t> static_order_;
+    ColliderBuffer static_sorted_;
+    // Largest max_x so far within each static layer
+    std::vector<float> static_reach_;
+    LayerRanges static_layers_;
+    std::vector<LayerTask> tasks_;
+    std::vector<TaskChunk> chunks_;
+    std::vector<ColliderPair> hits_;
+    std::vector<std::vector<ColliderPair>> thread_hits_;
+    std::vector<CollisionEvent> events_;
+
+    void add_collider_object(const ObjectComponents& components) {
+        if (components.collider) {
+            // New static colliders flag a rebuild when checked
+            dynamic_indices_.push_back(colliders_.size());
+            collider_objects_.push_back(components);
+            colliders_.push_back(components.collider);
+            // Ids increase with registration order so that pair keys sort in
+            // the same order as collider indices
+            collider_ids_.push_back(next_collider_id_++);
+        }
+    }
+
+    static void remap_indices(const std::vector<size_t>& remap,
+                              size_t removed_index,
+                              std::vector<size_t>& indices) {
+        size_t size = 0;
+        for (size_t index : indices) {
+            if (remap[index] != removed_index) {
+                indices[size++] = remap[index];
+            }
+        }
+        indices.resize(size);
+    }
+
+    // Fill bounds of non-static colliders, rebuild static colliders if
+    // needed and detect collisions. bounds(i) returns the SDL_Rect or AABB
+    // of collider i.
+    template <typename F>
+    void collide(F bounds) {
+        check_static_colliders();
+        buffer_.resize(colliders_.size());
+        if (statics_dirty_) {
+            build_static_colliders(bounds);
+        } else if (statics_moved_) {
+            project_static_colliders(bounds);
+        }
+        for (size_t i : dynamic_indices_) {
+            buffer_.set(i, bounds(i), colliders_[i]->collider.enabled);
+        }
+        detect_collisions();
+    }
+
+    // Everything about a collider that static colliders are built from, 0
+    // for non-static colliders
+    static inline uint64_t get_static_state(const ColliderComponent& collider) {
+        if (!collider.is_static) {
+            return 0;
+        }
+        return (static_cast<uint64_t>(1) << 41) |
+               (static_cast<uint64_t>(collider.enabled) << 40) |
+               (static_cast<uint64_t>(collider.layer) << 32) |
+               collider.layer_mask;
+    }
+
+    // Flag static colliders for a rebuild if any collider changed
+    void check_static_colliders() {
+        static_states_.resize(colliders_.size(), 0);
+        for (size_t i = 0; i < colliders_.size(); ++i) {
+            const ColliderComponent& collider = colliders_[i]->collider;
+            if (collider.layer >= COLLIDER_LAYER_COUNT) {
+                throw ValiantError("Invalid collider layer: " +
+                                   std::to_string(collider.layer));
+            }
+            uint64_t state = get_static_state(collider);
+            if (state != static_states_[i]) {
+                static_states_[i] = state;
+                statics_dirty_ = true;
+            }
+        }
+    }
+
+    template <typename F>
+    void build_static_colliders(F bounds) {
+        dynamic_indices_.clear();
+        static_indices_.clear();
+        for (size_t i = 0; i < colliders_.size(); ++i) {
+            const ColliderComponent& collider = colliders_[i]->collider;
+            if (collider.is_static) {
+                buffer_.set(i, bounds(i), collider.enabled);
+                static_indices_.push_back(i);
+            } else {
+                dynamic_indices_.push_back(i);
+            }
+        }
+        pack_layers(static_indices_, static_order_, static_sorted_,
+                    static_layers_, true);
+        fill_static_reach();
+        statics_dirty_ = false;
+        statics_moved_ = false;
+        ++static_builds_;
+    }
+
+    // Update the bounds of the packed static colliders, keeping their layers.
+    // Moving the camera keeps them in order along the x axis except for
+    // rounding, so sorting again is rarely needed.
+    template <typename F>
+    void project_static_colliders(F bounds) {
+        for (size_t i : static_indices_) {
+            buffer_.set(i, bounds(i), colliders_[i]->collider.enabled);
+        }
+        const std::vector<float>& min_x = buffer_.min_x;
+        auto by_min_x = [&min_x](size_t a, size_t b) {
+            return min_x[a] < min_x[b];
+        };
+        for (uint8_t layer = 0; layer < COLLIDER_LAYER_COUNT; ++layer) {
+            auto begin = static_order_.begin() + static_layers_.begin[layer];
+            auto end = static_order_.begin() + static_layers_.end[layer];
+            if (!std::is_sorted(begin, end, by_min_x)) {
+                std::sort(begin, end, by_min_x);
+            }
+        }
+        for (size_t p = 0; p < static_order_.size(); ++p) {
+            static_sorted_.copy(p, buffer_, static_order_[p]);
+        }
+        fill_static_reach();
+        statics_moved_ = false;
+    }
+
+    void fill_static_reach() {
+        static_reach_.resize(static_sorted_.size());
+        for (uint8_t layer = 0; layer < COLLIDER_LAYER_COUNT; ++layer) {
+            float reach = -std::numeric_limits<float>::infinity();
+            for (size_t p = static_layers_.begin[layer];
+                 p < static_layers_.end[layer]; ++p) {
+                reach = std::max(reach, static_sorted_.max_x[p]);
+                static_reach_[p] = reach;
+            }
+        }
+    }
+
+    // Run once the buffer holds this frame's bounds
+    void detect_collisions() {
+        hits_.clear();
+        pack_layers(dynamic_indices_, sweep_order_, sorted_, layers_,
+                    broad_phase_ == BroadPhase::SWEEP_AND_PRUNE);
+        fill_tasks();
+        // Brute force rows get shorter towards the end, so use small chunks
+        size_t grain = broad_phase_ == BroadPhase::BRUTE_FORCE
+                           ? BRUTE_FORCE_GRAIN
+                           : SWEEP_GRAIN;
+        if (thread_count_ <= 1) {
+            for (const LayerTask& task : tasks_) {
+                run_task(task, task.begin, task.end, hits_);
+            }
+        } else {
+            for_each_task(grain);
+        }
+        update_contacts();
+        dispatch_events();
+    }
+
+    // Group the active colliders among indices by layer into packed, with
+    // order holding the collider index of each packed entry. Within a layer
+    // colliders can be sorted along the x axis for sweep and prune.
+    void pack_layers(const std::vector<size_t>& indices,
+                     std::vector<size_t>& order, ColliderBuffer& packed,
+                     LayerRanges& layers, bool sort) const {
+        size_t counts[COLLIDER_LAYER_COUNT] = {};
+        for (size_t i : indices) {
+            if (buffer_.enabled[i]) {
+                ++counts[colliders_[i]->collider.layer];
+            }
+        }
+        size_t offset = 0;
+        for (uint8_t layer = 0; layer < COLLIDER_LAYER_COUNT; ++layer) {
+            layers.begin[layer] = offset;
+            layers.end[layer] = offset;
+            layers.mask[layer] = 0;
+            offset += counts[layer];
+        }
+        order.resize(offset);
+        for (size_t i : indices) {
+            if (buffer_.enabled[i]) {
+                const ColliderComponent& collider = colliders_[i]->collider;
+                order[layers.end[collider.layer]++] = i;
+                layers.mask[collider.layer] |= collider.layer_mask;
+            }
+        }
+        if (sort) {
+            const std::vector<float>& min_x = buffer_.min_x;
+            for (uint8_t layer = 0; layer < COLLIDER_LAYER_COUNT; ++layer) {
+                std::sort(order.begin() + layers.begin[layer],
+                          order.begin() + layers.end[layer],
+                          [&min_x](size_t a, size_t b) {
+                              return min_x[a] < min_x[b];
+                          });
+            }
+        }
+        // Pack bounds so each layer, and each sweep range, is contiguous
+        packed.resize(order.size());
+        for (size_t p = 0; p < order.size(); ++p) {
+            packed.copy(p, buffer_, order[p]);
+        }
+    }
+
+    // Queue tasks for every pair of layers that accept each other. Layer
+    // pairs that are masked out are never visited, and neither are pairs of
+    // static layers.
+    void fill_tasks() {
+        tasks_.clear();
+        for (uint8_t layer_1 = 0; layer_1 < COLLIDER_LAYER_COUNT; ++layer_1) {
+            if (layers_.begin[layer_1] == layers_.end[layer_1]) {
+                continue;
+            }
+            for (uint8_t layer_2 = layer_1; layer_2 < COLLIDER_LAYER_COUNT;
+                 ++layer_2) {
+                if (layers_.begin[layer_2] != layers_.end[layer_2] &&
+                    layers_accept(layers_, layer_1, layers_, layer_2)) {
+                    add_tasks(layer_1, layer_2);
+                }
+            }
+            for (uint8_t layer_2 = 0; layer_2 < COLLIDER_LAYER_COUNT;
+                 ++layer_2) {
+                if (static_layers_.begin[layer_2] !=
+                        static_layers_.end[layer_2] &&
+                    layers_accept(layers_, layer_1, static_layers_, layer_2)) {
+                    tasks_.push_back({layers_.begin[layer_1],
+                                      layers_.end[layer_1],
+                                      static_layers_.begin[layer_2],
+                                      static_layers_.end[layer_2], false,
+                                      false, true});
+                }
+            }
+        }
+    }
+
+    // Layers accept each other if any active colliders on them do
+    static inline bool layers_accept(const LayerRanges& layers_1,
+                                     uint8_t layer_1,
+                                     const LayerRanges& layers_2,
+                                     uint8_t layer_2) {
+        return (layers_1.mask[layer_1] >> layer_2) & 1 &&
+               (layers_2.mask[layer_2] >> layer_1) & 1;
+    }
+
+    void add_tasks(uint8_t layer_1, uint8_t layer_2) {
+        size_t begin_1 = layers_.begin[layer_1];
+        size_t end_1 = layers_.end[layer_1];
+        size_t begin_2 = layers_.begin[layer_2];
+        size_t end_2 = layers_.end[layer_2];
+        if (layer_1 == layer_2) {
+            tasks_.push_back(
+                {begin_1, end_1, begin_1, end_1, true, false, false});
+        } else if (broad_phase_ == BroadPhase::BRUTE_FORCE) {
+            tasks_.push_back(
+                {begin_1, end_1, begin_2, end_2, false, false, false});
+        } else {
+            // Each pair is found from the collider that starts first along
+            // the x axis, ties go to the first layer
+            tasks_.push_back(
+                {begin_1, end_1, begin_2, end_2, false, false, false});
+            tasks_.push_back(
+                {begin_2, end_2, begin_1, end_1, false, true, false});
+        }
+    }
+
+    // Split tasks into chunks of at most grain colliders and run them across
+    // the worker threads. Hits are only collected here, callbacks are
+    // dispatched later in key order so the result does not depend on how
+    // work was split.
+    void for_each_task(size_t grain) {
+        if (!job_system_) {
+            job_system_.reset(new JobSystem(thread_count_));
+        }
+        chunks_.clear();
+        for (size_t t = 0; t < tasks_.size(); ++t) {
+            for (size_t begin = tasks_[t].begin; begin < tasks_[t].end;
+                 begin += grain) {
+                chunks_.push_back(
+                    {t, begin, std::min(begin + grain, tasks_[t].end)});
+            }
+        }
+        thread_hits_.resize(job_system_->thread_count());
+        for (std::vector<ColliderPair>& hits : thread_hits_) {
+            hits.clear();
+        }
+        job_system_->parallel_for(
+            chunks_.size(), 1, [this](size_t begin, size_t end, size_t worker) {
+                for (size_t c = begin; c < end; ++c) {
+                    const TaskChunk& chunk = chunks_[c];
+                    run_task(tasks_[chunk.task], chunk.begin, chunk.end,
+                             thread_hits_[worker]);
+                }
+            });
+        for (const std::vector<ColliderPair>& hits : thread_hits_) {
+            hits_.insert(hits_.end(), hits.begin(), hits.end());
+        }
+    }
+
+    // Test colliders [begin, end) of a task against its target range
+    void run_task(const LayerTask& task, size_t begin, size_t end,
+                  std::vector<ColliderPair>& hits) const {
+        const ColliderBuffer& targets =
+            task.static_target ? static_sorted_ : sorted_;
+        const std::vector<size_t>& target_order =
+            task.static_target ? static_order_ : sweep_order_;
+        const std::vector<float>& min_x = targets.min_x;
+        bool sweep = broad_phase_ == BroadPhase::SWEEP_AND_PRUNE;
+        for (size_t p = begin; p < end; ++p) {
+            AABB box = sorted_.get(p);
+            size_t target_begin = task.target_begin;
+            size_t target_end = task.target_end;
+            if (task.same_layer) {
+                target_begin = p + 1;
+            } else if (sweep && task.static_target) {
+                // Statics are never swept themselves, so skip only those
+                // ending before this collider starts
+                target_begin = static_cast<size_t>(
+                    std::upper_bound(static_reach_.begin() + target_begin,
+                                     static_reach_.begin() + target_end,
+                                     box.min_x) -
+                    static_reach_.begin());
+            } else if (sweep) {
+                // Only colliders starting at or after this one
+                target_begin = static_cast<size_t>(
+                    (task.after_ties
+                         ? std::upper_bound(min_x.begin() + target_begin,
+                                            min_x.begin() + target_end,
+                                            box.min_x)
+                         : std::lower_bound(min_x.begin() + target_begin,
+                                            min_x.begin() + target_end,
+                                            box.min_x)) -
+                    min_x.begin());
+            }
+            if (sweep) {
+                // Colliders starting at or after this one's right edge can
+                // not overlap it
+                target_end = static_cast<size_t>(
+                    std::lower_bound(min_x.begin() + target_begin,
+                                     min_x.begin() + target_end, box.max_x) -
+                    min_x.begin());
+            }
+            const ColliderComponent& collider =
+                colliders_[sweep_order_[p]]->collider;
+            for (size_t start = target_begin; start < target_end;
+                 start += OVERLAP_BLOCK_SIZE) {
+                size_t count = std::min(OVERLAP_BLOCK_SIZE, target_end - start);
+                uint32_t mask = targets.overlap_mask(box, start, count);
+                while (mask) {
+                    size_t q = target_order[start +
+                                            OverlapKernel::lowest_bit(mask)];
+                    mask &= mask - 1;
+                    // Layers can be shared by colliders with different masks
+                    if (collider.accepts(colliders_[q]->collider)) {
+                        hits.emplace_back(sweep_order_[p], q);
+                    }
+                }
+            }
+        }
+    }
+
+    // Diff this frame's hits against the previous frame's contacts
+    void update_contacts() {
+        previous_contacts_.swap(contacts_);
+        contacts_.clear();
+        events_.clear();
+        for (const ColliderPair& pair : hits_) {
+            uint64_t key = PairSet::make_key(collider_ids_[pair.first],
+                                             collider_ids_[pair.second]);
+            contacts_.insert(key);
+            events_.push_back({key, previous_contacts_.contains(key)
+                                        ? CollisionEventType::STAY
+                                        : CollisionEventType::ENTER});
+        }
+        for (uint64_t key : previous_contacts_.keys()) {
+            if (!contacts_.contains(key)) {
+                events_.push_back({key, CollisionEventType::EXIT});
+            }
+        }
+        // Dispatching in key order matches the (i, j) order of a brute force
+        // pass over all pairs
+        std::sort(events_.begin(), events_.end());
+    }
+
+    void dispatch_events() {
+        for (const CollisionEvent& event : events_) {
+            size_t i = collider_index(PairSet::first_id(event.key));
+            size_t j = collider_index(PairSet::second_id(event.key));
+            Collider* collider_1 = colliders_[i];
+            Collider* collider_2 = colliders_[j];
+            Collision collision_from_1 =
+                get_collision_from_object(collider_objects_[i].object);
+            Collision collision_from_2 =
+                get_collision_from_object(collider_objects_[j].object);
+            switch (event.type) {
+                case CollisionEventType::ENTER:
+                    // Objects were not colliding previously, but are
+                    // colliding right now
+                    collider_1->on_collision_enter(collision_from_2);
+                    collider_2->on_collision_enter(collision_from_1);
+                    break;
+                case CollisionEventType::STAY:
+                    // Objects collided before and are colliding right now
+                    collider_1->on_collision_stay(collision_from_2);
+                    collider_2->on_collision_stay(collision_from_1);
+                    break;
+                case CollisionEventType::EXIT:
+                    // Objects were previously colliding
+                    collider_1->on_collision_exit(collision_from_2);
+                    collider_2->on_collision_exit(collision_from_1);
+                    break;
+            }
+        }
+    }
+
+    inline size_t collider_index(uint32_t id) const {
+        return static_cast<size_t>(
+            std::lower_bound(collider_ids_.begin(), collider_ids_.end(), id) -
+            collider_ids_.begin());
+    }
 };
 
+// Objects with a sprite renderer or rectangle component during the last
+// frame, split by whether they were inside the camera, and the draw calls
+// they were submitted with
+struct RenderStats {
+    size_t drawn;
+    size_t culled;
+    size_t batches;
+};
+
+// Seconds spent by the last frame in each phase. With a fixed timestep,
+// update and collision add up every step of the frame. Applying object
+// changes counts as update, uploading images as render.
+struct FrameTimings {
+    double update;
+    double collision;
+    double render;
+    double present;
+
+    inline double total() const {
+        return update + collision + render + present;
+    }
+};
+
+// Sprites sort after rectangles of the same z
+const uint64_t SPRITE_BATCH_KEY = static_cast<uint64_t>(1) << 63;
+
+// Objects are drawn by increasing z, then grouped by batch so that objects
+// drawn with one call are next to each other, then in the order they were
+// added
+struct DrawKey {
+    float z;
+    // Texture of sprites, color and fill of rectangles
+    uint64_t batch;
+    uint32_t index;
+
+    inline bool operator<(const DrawKey& key) const {
+        if (z != key.z) {
+            return z < key.z;
+        }
+        if (batch != key.batch) {
+            return batch < key.batch;
+        }
+        return index < key.index;
+    }
+};
+
+// Function run on the entities of a registry every update, with the
+// seconds elapsed
+typedef std::function<void(Registry&, double)> System;
+// System splitting its work across the threads of a job system
+typedef std::function<void(Registry&, double, JobSystem&)> ParallelSystem;
+
 class Renderer : public ObjectManager {
    public:
     explicit Renderer(uint_fast8_t flags = ENABLE)
         : flags_(flags),
+          collision_space_(CollisionSpace::SCREEN),
+          started_(false),
+          use_atlas_(true),
+          uploads_per_frame_(ASYNC_UPLOADS_PER_FRAME),
+          culling_(true),
+          cull_grid_dirty_(true),
+          render_stats_({0, 0, 0}),
+          texture_grouping_(true),
+          draw_frame_(0),
+          fixed_timestep_(0.),
+          max_fixed_steps_(MAX_FIXED_STEPS_PER_FRAME),
+          accumulator_(0.),
+          frame_rate_limit_(0.),
+          batch_page_(-1),
           background_color_(DEFAULT_BACKGROUND_COLOR),
-          camera_(nullptr),
+          placeholder_color_(DEFAULT_PLACEHOLDER_COLOR),
+          registry_(nullptr),
+          update_thread_count_(JobSystem::hardware_thread_count()),
+          camera_(&default_camera_),
           window_width_(DEFAULT_WINDOW_WIDTH),
           window_height_(DEFAULT_WINDOW_HEIGHT),
           has_camera_(false),
+          frame_timings_({0., 0., 0., 0.}),
           renderer_(nullptr),
-          window_(nullptr) {
+          window_(nullptr),
+          surface_(nullptr) {
         initialize_sdl();
     }
 
@@ -183,32 +943,264 @@ class Renderer : public ObjectManager {
     Renderer(const Renderer& renderer)
         : flags_(renderer.flags_),
           collision_manager_(renderer.collision_manager_),
+          collision_space_(renderer.collision_space_),
+          started_(renderer.started_),
+          use_atlas_(renderer.use_atlas_),
+          uploads_per_frame_(renderer.uploads_per_frame_),
+          culling_(renderer.culling_),
+          cull_grid_dirty_(true),
+          render_stats_(renderer.render_stats_),
+          texture_grouping_(renderer.texture_grouping_),
+          draw_frame_(0),
+          fixed_timestep_(renderer.fixed_timestep_),
+          max_fixed_steps_(renderer.max_fixed_steps_),
+          accumulator_(renderer.accumulator_),
+          frame_rate_limit_(renderer.frame_rate_limit_),
+          batch_page_(-1),
           objects_(renderer.objects_),
+          added_objects_(renderer.added_objects_),
+          removed_objects_(renderer.removed_objects_),
           background_color_(renderer.background_color_),
-          camera_(renderer.camera_),
+          placeholder_color_(renderer.placeholder_color_),
+          registry_(renderer.registry_),
+          systems_(renderer.systems_),
+          update_thread_count_(renderer.update_thread_count_),
+          camera_(renderer.has_camera_ ? renderer.camera_
+                                       : &default_camera_),
           window_width_(renderer.window_width_),
           window_height_(renderer.window_height_),
           has_camera_(renderer.has_camera_),
+          frame_timings_(renderer.frame_timings_),
           renderer_(renderer.renderer_),
-          window_(renderer.window_) {}
+          window_(renderer.window_),
+          surface_(renderer.surface_) {}
 
+    // Once run has been called, objects are added at the end of the current
+    // frame. Their awake and start methods are called when they are added.
+    // Components are resolved here from the static type of object.
     template <typename T>
     inline void add_object(T& object) {
-        objects_.push_back(&object);
+        if (started_) {
+            added_objects_.push_back(get_object_components(object));
+        } else {
+            objects_.push_back(get_object_components(object));
+        }
+    }
+
+    // Once run has been called, objects are removed at the end of the current
+    // frame after receiving exit callbacks for their contacts
+    template <typename T>
+    void remove_object(T& object) {
+        Object* removed = &object;
+        auto is_removed = [removed](const ObjectComponents& components) {
+            return components.object == removed;
+        };
+        auto added = std::find_if(added_objects_.begin(),
+                                  added_objects_.end(), is_removed);
+        if (added != added_objects_.end()) {
+            // Never added, so nothing to remove
+            added_objects_.erase(added);
+        } else if (started_) {
+            removed_objects_.push_back(removed);
+        } else {
+            objects_.erase(
+                std::remove_if(objects_.begin(), objects_.end(), is_removed),
+                objects_.end());
+        }
     }
 
+    // Entities of registry are updated by the systems added and drawn after
+    // every object, without sorting by z. Their shape and sprite components
+    // are drawn like those of objects.
+    inline void set_registry(Registry& registry) { registry_ = &registry; }
+
+    inline Registry* registry() const { return registry_; }
+
+    // Systems run in the order they were added, after the update methods of
+    // objects and before the camera is updated
+    void add_system(const System& system) {
+        if (!registry_) {
+            throw ValiantError("Systems need a registry");
+        }
+        systems_.push_back({system, nullptr});
+    }
+
+    // Add a system calling function(entity, T&, Others&..., delta) for every
+    // entity with the components, split across the update threads. function
+    // may only change the components it is given.
+    template <typename T, typename... Others, typename F>
+    void add_parallel_system(F function) {
+        if (!registry_) {
+            throw ValiantError("Systems need a registry");
+        }
+        ParallelSystem parallel_system = [function](Registry& registry,
+                                                    double delta,
+                                                    JobSystem& job_system) {
+            // Pools are only read once threads share the registry
+            registry.prepare<T, Others...>();
+            job_system.parallel_for(
+                registry.pool<T>().size(), PARALLEL_UPDATE_GRAIN,
+                [&](size_t begin, size_t end, size_t) {
+                    registry.each<T, Others...>(
+                        begin, end,
+                        [&](Entity entity, T& component, Others&... others) {
+                            function(entity, component, others..., delta);
+                        });
+                });
+        };
+        systems_.push_back({nullptr, parallel_system});
+    }
+
+    // Update methods of objects deriving from ParallelUpdate, and parallel
+    // systems, are split across thread_count threads including the one
+    // running frames. 0 uses one thread per hardware thread, the default.
+    void set_update_thread_count(size_t thread_count) {
+        if (thread_count == 0) {
+            thread_count = JobSystem::hardware_thread_count();
+        }
+        if (thread_count != update_thread_count_) {
+            update_thread_count_ = thread_count;
+            update_jobs_.reset();
+        }
+    }
+
+    inline size_t update_thread_count() const { return update_thread_count_; }
+
     inline void add_camera(Camera& camera) {
         has_camera_ = true;
         camera_ = &camera;
     }
 
+    inline void set_broad_phase(BroadPhase broad_phase) {
+        collision_manager_.set_broad_phase(broad_phase);
+    }
+
+    inline void set_collision_space(CollisionSpace collision_space) {
+        collision_space_ = collision_space;
+    }
+
+    auto collision_space() const -> CollisionSpace { return collision_space_; }
+
+    inline void set_collision_thread_count(size_t thread_count) {
+        collision_manager_.set_thread_count(thread_count);
+    }
+
+    // Pack images into shared atlas textures when they are uploaded so that
+    // sprites sharing a page are drawn in one call. Only affects images that
+    // have not been uploaded yet.
+    inline void set_texture_atlas(bool use_atlas) { use_atlas_ = use_atlas; }
+
+    inline bool texture_atlas() const { return use_atlas_; }
+
+    // Images loaded in the background are uploaded at most this many per
+    // frame so that loading many sprites does not stall a single frame
+    inline void set_uploads_per_frame(size_t uploads_per_frame) {
+        uploads_per_frame_ = uploads_per_frame;
+    }
+
+    inline size_t uploads_per_frame() const { return uploads_per_frame_; }
+
+    // Drawn over sprites whose image is not uploaded yet, transparent by
+    // default so nothing is drawn
+    void set_placeholder_color(Color color) { placeholder_color_ = color; }
+
+    auto placeholder_color() const -> Color { return placeholder_color_; }
+
+    // Skip objects outside the camera. Objects are looked up in a grid, so
+    // off-screen objects are not visited when drawing.
+    inline void set_culling(bool culling) { culling_ = culling; }
+
+    inline bool culling() const { return culling_; }
+
+    inline RenderStats render_stats() const { return render_stats_; }
+
+    // Objects with equal z are grouped by texture, and rectangles by color
+    // and fill, so they can be drawn in batches. Without grouping they are
+    // drawn in the order they were added.
+    inline void set_texture_grouping(bool texture_grouping) {
+        texture_grouping_ = texture_grouping;
+    }
+
+    inline bool texture_grouping() const { return texture_grouping_; }
+
+    // Objects drawn by the last frame, in draw order
+    std::vector<Object*> get_draw_order() const {
+        std::vector<Object*> objects;
+        objects.reserve(draw_order_.size());
+        for (const DrawKey& key : draw_order_) {
+            objects.push_back(objects_[key.index].object);
+        }
+        return objects;
+    }
+
+    // Run update methods and collisions every seconds instead of once per
+    // frame, so the simulation does not depend on the frame rate. A frame
+    // runs as many steps as the time elapsed covers, up to max_steps, and is
+    // drawn once. Setting seconds to 0 goes back to one update per frame.
+    void set_fixed_timestep(double seconds,
+                            size_t max_steps = MAX_FIXED_STEPS_PER_FRAME) {
+        if (seconds < 0 || max_steps == 0) {
+            throw ValiantError("Invalid fixed timestep: " +
+                               std::to_string(seconds) + " seconds, " +
+                               std::to_string(max_steps) + " steps");
+        }
+        fixed_timestep_ = seconds;
+        max_fixed_steps_ = max_steps;
+        accumulator_ = 0.;
+    }
+
+    inline double fixed_timestep() const { return fixed_timestep_; }
+
+    // Sleep at the end of frames shorter than 1 / frames_per_second instead
+    // of starting the next one, 0 removes the limit
+    void set_frame_rate_limit(double frames_per_second) {
+        if (frames_per_second < 0) {
+            throw ValiantError("Invalid frame rate limit: " +
+                               std::to_string(frames_per_second));
+        }
+        frame_rate_limit_ = frames_per_second;
+    }
+
+    inline double frame_rate_limit() const { return frame_rate_limit_; }
+
+    // Call after moving or resizing a static collider
+    inline void invalidate_static_colliders() {
+        collision_manager_.invalidate_static_colliders();
+        cull_grid_dirty_ = true;
+    }
+
     auto window_width() const -> int { return window_width_; }
 
     auto window_height() const -> int { return window_height_; }
 
     auto background_color() const -> Color { return background_color_; }
 
-    std::vector<Object*> get_objects() { return objects_; }
+    // Objects whose tag is tag, in update order. The index is rebuilt by the
+    // first search of every update, so tags changed after it are found from
+    // the next update. Not safe to call from parallel updates.
+    const std::vector<Object*>& find_objects_with_tag(Tag tag) {
+        static const std::vector<Object*> none;
+        if (tags_dirty_) {
+            index_tags();
+        }
+        return tag.id() < tagged_objects_.size() ? tagged_objects_[tag.id()]
+                                                 : none;
+    }
+
+    // First object whose tag is tag, or null
+    Object* find_object_with_tag(Tag tag) {
+        const std::vector<Object*>& objects = find_objects_with_tag(tag);
+        return objects.empty() ? nullptr : objects.front();
+    }
+
+    std::vector<Object*> get_objects() const {
+        std::vector<Object*> objects;
+        objects.reserve(objects_.size());
+        for (const ObjectComponents& components : objects_) {
+            objects.push_back(components.object);
+        }
+        return objects;
+    }
 
     void set_background_color(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
         background_color_.r = r;
@@ -245,25 +1237,8 @@ class Renderer : public ObjectManager {
     }
 
     void run() {
-        collision_manager_.fill_collider_objects(objects_);
-        // Check if camera has been added
-        Camera new_camera;
-        if (!has_camera_) {
-            // Create a camera as no camera has been added
-            camera_ = &new_camera;
-        }
-        // Run awake methods
-        for (auto object : objects_) {
-            object->awake();
-        }
-        camera_->awake();
-        // Run start methods
-        for (auto object : objects_) {
-            object->start();
-        }
-        camera_->start();
+        start_objects();
         if (flags_ & ENABLE) {
-            SDL_Event event;
             bool quit = false;
             uint64_t start = SDL_GetPerformanceCounter();
             while (!quit) {
@@ -274,80 +1249,696 @@ class Renderer : public ObjectManager {
                 double delta =
                     (start - last) /
                     static_cast<double>(SDL_GetPerformanceFrequency());
-                if (SDL_PollEvent(&event) != 0) {
-                    if (event.type == SDL_QUIT) {
-                        quit = true;
-                    }
-                }
-                // Run update methods
-                for (auto object : objects_) {
-                    object->input.event = event;
-                    object->time.set(delta);
-                    object->update();
-                }
-                camera_->input.event = event;
-                camera_->time.set(delta);
-                camera_->update();
-                // Get camera data
-                CameraData camera_data = {camera_->camera.size,
-                                          camera_->transform.position};
-                // Rendering
-                SDL_SetRenderDrawColor(renderer_, background_color_.r,
-                                       background_color_.g, background_color_.b,
-                                       background_color_.a);
-                SDL_RenderClear(renderer_);
-                render(camera_data);
-                collision_manager_.process_collisions(camera_data);
-                SDL_RenderPresent(renderer_);
+                quit = !poll_events();
+                step(delta);
+                limit_frame_rate(start);
             }
         }
     }
 
+    // Run frames frames of delta seconds each, without polling events or
+    // sleeping, so runs can be repeated and timed. Objects are started
+    // first if run has not been called.
+    void run_frames(size_t frames, double delta) {
+        if (!started_) {
+            start_objects();
+        }
+        for (size_t frame = 0; frame < frames; ++frame) {
+            step(delta);
+        }
+    }
+
+    // Phases of the last frame run by step
+    inline FrameTimings frame_timings() const { return frame_timings_; }
+
+    // Feed every queued event to the keyboard state. Returns false once the
+    // window was closed. Called by run before every frame, call it before
+    // step when running frames directly.
+    static bool poll_events() {
+        bool open = true;
+        SDL_Event event;
+        while (SDL_PollEvent(&event) != 0) {
+            if (event.type == SDL_QUIT) {
+                open = false;
+            }
+            KeyboardState::instance().process(event);
+        }
+        return open;
+    }
+
+    // Run a single frame: update, render, collide and apply object changes.
+    // Called by run for every frame, or directly once run has returned when
+    // the renderer is disabled. With a fixed timestep, delta is added to the
+    // time left to simulate and every step updates, collides and applies
+    // object changes before the frame is drawn.
+    void step(double delta) {
+        frame_timings_ = {0., 0., 0., 0.};
+        uint64_t counter = SDL_GetPerformanceCounter();
+        if (fixed_timestep_ <= 0) {
+            Context::time.set_alpha(0.);
+            update_objects(delta);
+            frame_timings_.update += lap(counter);
+            CameraData camera_data = get_camera_data();
+            draw_frame(camera_data);
+            frame_timings_.render += lap(counter);
+            process_collisions(camera_data);
+            frame_timings_.collision += lap(counter);
+            SDL_RenderPresent(renderer_);
+            frame_timings_.present += lap(counter);
+            apply_object_changes();
+            frame_timings_.update += lap(counter);
+            return;
+        }
+        accumulator_ += delta;
+        size_t steps = 0;
+        while (accumulator_ >= fixed_timestep_ && steps < max_fixed_steps_) {
+            update_objects(fixed_timestep_);
+            frame_timings_.update += lap(counter);
+            process_collisions(get_camera_data());
+            frame_timings_.collision += lap(counter);
+            apply_object_changes();
+            frame_timings_.update += lap(counter);
+            accumulator_ -= fixed_timestep_;
+            ++steps;
+        }
+        if (accumulator_ >= fixed_timestep_) {
+            // Too far behind to catch up, drop whole steps so later frames
+            // do not fall further behind
+            accumulator_ = std::fmod(accumulator_, fixed_timestep_);
+        }
+        Context::time.set_alpha(accumulator_ / fixed_timestep_);
+        draw_frame(get_camera_data());
+        frame_timings_.render += lap(counter);
+        SDL_RenderPresent(renderer_);
+        frame_timings_.present += lap(counter);
+    }
+
    private:
     uint_fast8_t flags_;
     CollisionManager collision_manager_;
-    std::vector<Object*> objects_;
+    CollisionSpace collision_space_;
+    bool started_;
+    bool use_atlas_;
+    size_t uploads_per_frame_;
+    bool culling_;
+    // Objects indexed by position in objects_. Objects with a static
+    // collider are only placed when the grid is rebuilt, the others are
+    // moved every frame.
+    SpatialGrid cull_grid_;
+    bool cull_grid_dirty_;
+    std::vector<uint32_t> moving_objects_;
+    std::vector<uint32_t> visible_objects_;
+    RenderStats render_stats_;
+    // Visible objects sorted by DrawKey, kept across frames so that sorting
+    // only has to fix the few objects that changed
+    bool texture_grouping_;
+    std::vector<DrawKey> draw_order_;
+    std::vector<DrawKey> new_draw_keys_;
+    std::vector<DrawKey> draw_scratch_;
+    // Frame each object was last seen visible or kept in draw order
+    std::vector<uint64_t> draw_frames_;
+    uint64_t draw_frame_;
+    // Seconds per update, 0 updates once per frame
+    double fixed_timestep_;
+    size_t max_fixed_steps_;
+    // Frame time not yet simulated by fixed steps
+    double accumulator_;
+    // Frames per second run sleeps down to, 0 does not sleep
+    double frame_rate_limit_;
+    // Quads of consecutive sprites on the same atlas page
+    int batch_page_;
+    std::vector<SDL_Vertex> batch_vertices_;
+    std::vector<int> batch_indices_;
+    // Consecutive rectangles of the same color and fill
+    std::vector<SDL_Rect> batch_rects_;
+    Color batch_color_;
+    bool batch_fill_{false};
+    // Objects in the order they are updated, and drawn within equal keys
+    std::vector<ObjectComponents> objects_;
+    // Objects added and removed during the current frame
+    std::vector<ObjectComponents> added_objects_;
+    std::vector<Object*> removed_objects_;
+    // Scratch storage reused across frames
+    std::vector<ObjectComponents> applied_additions_;
+    std::vector<Object*> applied_removals_;
+    // Objects by tag id, buckets are kept across rebuilds
+    std::vector<std::vector<Object*>> tagged_objects_;
+    bool tags_dirty_{true};
     Color background_color_;
+    Color placeholder_color_;
+    Registry* registry_;
+    // Either function is set
+    struct SystemEntry {
+        System system;
+        ParallelSystem parallel_system;
+    };
+    std::vector<SystemEntry> systems_;
+    // Threads for parallel updates, started by the first one
+    size_t update_thread_count_;
+    std::unique_ptr<JobSystem> update_jobs_;
+    // Consecutive parallel objects waiting for their update
+    std::vector<Object*> parallel_objects_;
+    // Used when no camera has been added
+    Camera default_camera_;
     Camera* camera_{nullptr};
     int window_width_;
     int window_height_;
     bool has_camera_{false};
+    FrameTimings frame_timings_;
     SDL_Renderer* renderer_;
     SDL_Window* window_;
+    // Drawn to instead of a window when headless
+    SDL_Surface* surface_;
+
+    // Run awake and start methods of the objects added so far
+    void start_objects() {
+        started_ = true;
+        collision_manager_.fill_collider_components(objects_);
+        // Run awake methods
+        for (const ObjectComponents& components : objects_) {
+            components.object->awake();
+        }
+        camera_->awake();
+        // Run start methods
+        for (const ObjectComponents& components : objects_) {
+            components.object->start();
+        }
+        camera_->start();
+        // Objects added or removed by awake and start methods
+        apply_object_changes();
+    }
+
+    // Seconds since counter, which is moved to now
+    static double lap(uint64_t& counter) {
+        uint64_t now = SDL_GetPerformanceCounter();
+        double seconds = (now - counter) /
+                         static_cast<double>(SDL_GetPerformanceFrequency());
+        counter = now;
+        return seconds;
+    }
+
+    // Key presses and releases are seen by exactly one update, frames
+    // running no fixed step keep them for the next frame. Objects deriving
+    // from ParallelUpdate are updated after the others, and every parallel
+    // update has finished before systems, collisions and drawing run.
+    void update_objects(double delta) {
+        Context::time.set(delta);
+        tags_dirty_ = true;
+        parallel_objects_.clear();
+        for (const ObjectComponents& components : objects_) {
+            if (components.parallel_update) {
+                parallel_objects_.push_back(components.object);
+            } else {
+                // Parallel objects added before this one update first
+                update_parallel_objects();
+                components.object->update();
+            }
+        }
+        update_parallel_objects();
+        for (const SystemEntry& entry : systems_) {
+            if (entry.parallel_system) {
+                entry.parallel_system(*registry_, delta, update_jobs());
+            } else {
+                entry.system(*registry_, delta);
+            }
+        }
+        camera_->update();
+        KeyboardState::instance().clear_transitions();
+    }
+
+    // Update the run of parallel objects gathered so far. Runs too short to
+    // split are updated on this thread.
+    void update_parallel_objects() {
+        if (parallel_objects_.size() < PARALLEL_UPDATE_GRAIN) {
+            for (Object* object : parallel_objects_) {
+                object->update();
+            }
+        } else {
+            update_jobs().parallel_for(
+                parallel_objects_.size(), PARALLEL_UPDATE_GRAIN,
+                [this](size_t begin, size_t end, size_t) {
+                    for (size_t i = begin; i < end; ++i) {
+                        parallel_objects_[i]->update();
+                    }
+                });
+        }
+        parallel_objects_.clear();
+    }
+
+    JobSystem& update_jobs() {
+        if (!update_jobs_) {
+            update_jobs_.reset(new JobSystem(update_thread_count_));
+        }
+        return *update_jobs_;
+    }
 
+    inline CameraData get_camera_data() const {
+        return {camera_->camera.size, camera_->transform.position};
+    }
+
+    void draw_frame(CameraData camera_data) {
+        SDL_SetRenderDrawColor(renderer_, background_color_.r,
+                               background_color_.g, background_color_.b,
+                               background_color_.a);
+        SDL_RenderClear(renderer_);
+        AssetCache::instance().process_uploads(renderer_, use_atlas_,
+                                               uploads_per_frame_);
+        render(camera_data);
+    }
+
+    void process_collisions(CameraData camera_data) {
+        if (collision_space_ == CollisionSpace::WORLD) {
+            collision_manager_.process_collisions();
+        } else {
+            collision_manager_.process_collisions(camera_data);
+        }
+    }
+
+    // Sleep out the rest of a frame that started at the performance counter
+    // value frame_start
+    void limit_frame_rate(uint64_t frame_start) {
+        if (frame_rate_limit_ <= 0) {
+            return;
+        }
+        double elapsed = (SDL_GetPerformanceCounter() - frame_start) /
+                         static_cast<double>(SDL_GetPerformanceFrequency());
+        double remaining = 1. / frame_rate_limit_ - elapsed;
+        if (remaining > 0) {
+            SDL_Delay(static_cast<uint32_t>(remaining * 1000));
+        }
+    }
+
+    void index_tags() {
+        for (std::vector<Object*>& objects : tagged_objects_) {
+            objects.clear();
+        }
+        for (const ObjectComponents& components : objects_) {
+            uint32_t id = components.object->tag.id();
+            if (id >= tagged_objects_.size()) {
+                tagged_objects_.resize(id + 1);
+            }
+            tagged_objects_[id].push_back(components.object);
+        }
+        tags_dirty_ = false;
+    }
+
+    // Apply queued additions and removals in one batch. Objects added by
+    // awake or start methods are applied in the next batch.
+    void apply_object_changes() {
+        tags_dirty_ = true;
+        if (!removed_objects_.empty()) {
+            applied_removals_.swap(removed_objects_);
+            removed_objects_.clear();
+            std::sort(applied_removals_.begin(), applied_removals_.end());
+            objects_.erase(
+                std::remove_if(objects_.begin(), objects_.end(),
+                               [this](const ObjectComponents& components) {
+                                   return std::binary_search(
+                                       applied_removals_.begin(),
+                                       applied_removals_.end(),
+                                       components.object);
+                               }),
+                objects_.end());
+            collision_manager_.remove_collider_objects(applied_removals_);
+            cull_grid_dirty_ = true;
+            // Indices in draw order are no longer valid
+            draw_order_.clear();
+        }
+        if (!added_objects_.empty()) {
+            applied_additions_.swap(added_objects_);
+            added_objects_.clear();
+            objects_.insert(objects_.end(), applied_additions_.begin(),
+                            applied_additions_.end());
+            collision_manager_.fill_collider_components(applied_additions_);
+            cull_grid_dirty_ = true;
+            for (const ObjectComponents& components : applied_additions_) {
+                components.object->awake();
+            }
+            for (const ObjectComponents& components : applied_additions_) {
+                components.object->start();
+            }
+        }
+    }
+
+    // Components are only read through references, so drawing does not copy
+    // sprites or their paths. Visible objects are drawn in DrawKey order.
+    // Consecutive sprites on the same atlas page, and consecutive rectangles
+    // of the same color and fill, are batched into one draw call. Anything
+    // else drawn in between ends the batch so draw order is kept.
     void render(CameraData camera_data) {
-        for (auto object : objects_) {
-            if (SpriteRenderer* sprite_object =
-                    dynamic_cast<SpriteRenderer*>(object)) {
-                // Object has sprite renderer component
-                SpriteRendererComponent sprite_renderer =
-                    sprite_object->sprite_renderer;
-                if (sprite_renderer.sprite.texture == nullptr) {
-                    // Texture has not been created yet
-                    sprite_object->sprite_renderer.sprite.create_texture(
-                        renderer_);
+        render_stats_ = {0, 0, 0};
+        visible_objects_.clear();
+        if (culling_) {
+            update_cull_grid();
+            cull_grid_.query(get_camera_world_bounds(camera_data),
+                             visible_objects_);
+            render_stats_.culled = cull_grid_.size() - visible_objects_.size();
+        } else {
+            for (size_t i = 0; i < objects_.size(); ++i) {
+                if (objects_[i].sprite_renderer || objects_[i].rectangle) {
+                    visible_objects_.push_back(static_cast<uint32_t>(i));
+                }
+            }
+        }
+        sort_draw_order();
+        for (const DrawKey& key : draw_order_) {
+            draw_object(objects_[key.index], camera_data);
+        }
+        if (registry_) {
+            render_entities(camera_data);
+        }
+        flush_batch();
+    }
+
+    // Entities are walked linearly in component order, and the ones outside
+    // the camera are skipped by comparing their bounds. Like objects, an
+    // entity with a sprite is drawn as its sprite and never as its shape.
+    void render_entities(CameraData camera_data) {
+        AABB camera_bounds = get_camera_world_bounds(camera_data);
+        auto visible = [this, &camera_bounds](const ObjectData& entity_data) {
+            AABB bounds = get_object_world_bounds(entity_data);
+            if (!culling_ || (bounds.min_x <= camera_bounds.max_x &&
+                              bounds.max_x >= camera_bounds.min_x &&
+                              bounds.min_y <= camera_bounds.max_y &&
+                              bounds.max_y >= camera_bounds.min_y)) {
+                ++render_stats_.drawn;
+                return true;
+            }
+            ++render_stats_.culled;
+            return false;
+        };
+        ComponentPool<SpriteRendererComponent>& sprites =
+            registry_->pool<SpriteRendererComponent>();
+        registry_->each<Shape, Transform>(
+            [&](Entity entity, const Shape& shape, const Transform& transform) {
+                if (sprites.contains(entity.index)) {
+                    return;
+                }
+                ObjectData entity_data =
+                    get_drawn_data(transform.position, nullptr, &shape);
+                if (visible(entity_data)) {
+                    draw_rectangle(shape, get_object_camera_position(
+                                              entity_data, camera_data));
                 }
-                SDL_Rect rect = get_object_camera_position(
-                    get_object_data(object), camera_data);
-                SDL_RendererFlip flip = (SDL_RendererFlip)(
-                    (sprite_renderer.flip_x ? SDL_FLIP_HORIZONTAL : 0) |
-                    (sprite_renderer.flip_y ? SDL_FLIP_VERTICAL : 0));
-                SDL_RenderCopyEx(renderer_, sprite_renderer.sprite.texture,
-                                 nullptr, &rect, 0.0, nullptr, flip);
-            } else if (Rectangle* rectangle_object =
-                           dynamic_cast<Rectangle*>(object)) {
-                // Object has rectangle component
-                Shape shape = rectangle_object->shape;
-                SDL_Rect rect = get_object_camera_position(
-                    get_object_data(object), camera_data);
-                SDL_SetRenderDrawColor(renderer_, shape.color.r, shape.color.g,
-                                       shape.color.b, shape.color.a);
-                if (shape.fill == true) {
-                    SDL_RenderFillRect(renderer_, &rect);
+            });
+        registry_->each<SpriteRendererComponent, Transform>(
+            [&](Entity, SpriteRendererComponent& sprite_renderer,
+                const Transform& transform) {
+                const Sprite& sprite = sprite_renderer.sprite;
+                // Sprites are drawn until they know their size
+                if (!sprite.ready ||
+                    visible(get_drawn_data(transform.position, &sprite,
+                                           nullptr))) {
+                    draw_sprite(sprite_renderer, transform.position,
+                                camera_data);
                 }
-                SDL_RenderDrawRect(renderer_, &rect);
+            });
+    }
+
+    DrawKey get_draw_key(uint32_t index) const {
+        const ObjectComponents& components = objects_[index];
+        float z = components.object->transform.position.z;
+        DrawKey key = {z == z ? z : 0, 0, index};
+        if (!texture_grouping_) {
+            return key;
+        }
+        if (components.sprite_renderer) {
+            const Image* image =
+                components.sprite_renderer->sprite_renderer.sprite.image.get();
+            if (image && image->atlas_page >= 0) {
+                key.batch = static_cast<uint64_t>(image->atlas_page);
+            } else if (image && image->texture) {
+                key.batch = reinterpret_cast<uintptr_t>(image->texture);
+            } else {
+                key.batch = reinterpret_cast<uintptr_t>(image);
             }
+            key.batch |= SPRITE_BATCH_KEY;
+        } else if (components.rectangle) {
+            const Shape& shape = components.rectangle->shape;
+            key.batch = (static_cast<uint64_t>(shape.fill) << 32) |
+                        (static_cast<uint64_t>(shape.color.r) << 24) |
+                        (static_cast<uint64_t>(shape.color.g) << 16) |
+                        (static_cast<uint64_t>(shape.color.b) << 8) |
+                        shape.color.a;
         }
+        return key;
+    }
+
+    // Objects still visible keep their place from the last frame, so their
+    // keys are mostly sorted and an insertion sort is close to linear.
+    // Objects that became visible are sorted on their own and merged in.
+    void sort_draw_order() {
+        uint64_t visible_frame = ++draw_frame_;
+        uint64_t kept_frame = ++draw_frame_;
+        if (draw_frames_.size() < objects_.size()) {
+            draw_frames_.resize(objects_.size(), 0);
+        }
+        for (uint32_t index : visible_objects_) {
+            draw_frames_[index] = visible_frame;
+        }
+        size_t kept = 0;
+        for (const DrawKey& key : draw_order_) {
+            if (draw_frames_[key.index] == visible_frame) {
+                draw_frames_[key.index] = kept_frame;
+                draw_order_[kept++] = get_draw_key(key.index);
+            }
+        }
+        draw_order_.resize(kept);
+        insertion_sort(draw_order_);
+        new_draw_keys_.clear();
+        for (uint32_t index : visible_objects_) {
+            if (draw_frames_[index] == visible_frame) {
+                new_draw_keys_.push_back(get_draw_key(index));
+            }
+        }
+        if (new_draw_keys_.empty()) {
+            return;
+        }
+        std::sort(new_draw_keys_.begin(), new_draw_keys_.end());
+        draw_scratch_.resize(draw_order_.size() + new_draw_keys_.size());
+        std::merge(draw_order_.begin(), draw_order_.end(),
+                   new_draw_keys_.begin(), new_draw_keys_.end(),
+                   draw_scratch_.begin());
+        draw_order_.swap(draw_scratch_);
+    }
+
+    // Falls back to std::sort once too many keys moved for the order to
+    // count as mostly sorted
+    static void insertion_sort(std::vector<DrawKey>& keys) {
+        size_t shifts = 0;
+        size_t shift_budget = 4 * keys.size() + 64;
+        for (size_t i = 1; i < keys.size(); ++i) {
+            DrawKey key = keys[i];
+            size_t j = i;
+            while (j > 0 && key < keys[j - 1]) {
+                keys[j] = keys[j - 1];
+                --j;
+                if (++shifts > shift_budget) {
+                    keys[j] = key;
+                    std::sort(keys.begin(), keys.end());
+                    return;
+                }
+            }
+            keys[j] = key;
+        }
+    }
+
+    void draw_object(const ObjectComponents& components,
+                     CameraData camera_data) {
+        if (SpriteRenderer* sprite_object = components.sprite_renderer) {
+            // Object has sprite renderer component
+            ++render_stats_.drawn;
+            const Sprite& sprite = sprite_object->sprite_renderer.sprite;
+            bool was_ready = sprite.ready;
+            draw_sprite(sprite_object->sprite_renderer,
+                        components.object->transform.position, camera_data);
+            if (!was_ready && sprite.ready && components.collider &&
+                components.collider->collider.is_static) {
+                // Static bounds were cached with the placeholder size
+                collision_manager_.invalidate_static_colliders();
+            }
+        } else if (Rectangle* rectangle_object = components.rectangle) {
+            // Object has rectangle component
+            ++render_stats_.drawn;
+            draw_rectangle(rectangle_object->shape,
+                           get_object_camera_position(
+                               get_object_data(components), camera_data));
+        }
+    }
+
+    void draw_sprite(SpriteRendererComponent& sprite_renderer,
+                     const Vector3& position, CameraData camera_data) {
+        Sprite& sprite = sprite_renderer.sprite;
+        Image* image = sprite.image.get();
+        if (image == nullptr) {
+            // No sprite has been loaded
+            return;
+        }
+        if (!image->error.empty()) {
+            // Decoding in the background failed, thrown like a failed load
+            throw ValiantError(image->error);
+        }
+        // Uploads once per image, not once per sprite. Images still
+        // loading in the background are left to process_uploads.
+        AssetCache::instance().upload(*image, renderer_, use_atlas_);
+        if (!image->is_uploaded()) {
+            draw_placeholder(get_object_camera_position(
+                {sprite.width, sprite.height, position}, camera_data));
+            return;
+        }
+        if (!sprite.ready) {
+            // Placeholder size is replaced by the image size
+            sprite.width = image->width;
+            sprite.height = image->height;
+            sprite.ready = true;
+            cull_grid_dirty_ = true;
+        }
+        SDL_Rect rect = get_object_camera_position(
+            {sprite.width, sprite.height, position}, camera_data);
+        if (image->atlas_page >= 0) {
+            draw_atlas_sprite(sprite_renderer, *image, rect);
+            return;
+        }
+        flush_batch();
+        SDL_RendererFlip flip = (SDL_RendererFlip)(
+            (sprite_renderer.flip_x ? SDL_FLIP_HORIZONTAL : 0) |
+            (sprite_renderer.flip_y ? SDL_FLIP_VERTICAL : 0));
+        ++render_stats_.batches;
+        SDL_RenderCopyEx(renderer_, image->texture, nullptr, &rect, 0.0,
+                         nullptr, flip);
+    }
+
+    void draw_rectangle(const Shape& shape, const SDL_Rect& rect) {
+        bool same_batch =
+            batch_indices_.empty() &&
+            (batch_rects_.empty() ||
+             (shape.fill == batch_fill_ && shape.color == batch_color_));
+        if (!same_batch) {
+            flush_batch();
+        }
+        batch_color_ = shape.color;
+        batch_fill_ = shape.fill;
+        batch_rects_.push_back(rect);
+    }
+
+    // Place every drawable object in the grid after objects changed, then
+    // move the objects that can move
+    void update_cull_grid() {
+        if (cull_grid_dirty_) {
+            cull_grid_.clear();
+            moving_objects_.clear();
+            for (size_t i = 0; i < objects_.size(); ++i) {
+                const ObjectComponents& components = objects_[i];
+                if (!components.sprite_renderer && !components.rectangle) {
+                    continue;
+                }
+                if (components.collider &&
+                    components.collider->collider.is_static) {
+                    cull_grid_.update(static_cast<uint32_t>(i),
+                                      get_cull_bounds(components));
+                } else {
+                    moving_objects_.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            cull_grid_dirty_ = false;
+        }
+        for (uint32_t index : moving_objects_) {
+            cull_grid_.update(index, get_cull_bounds(objects_[index]));
+        }
+    }
+
+    static AABB get_cull_bounds(const ObjectComponents& components) {
+        if (components.sprite_renderer &&
+            !components.sprite_renderer->sprite_renderer.sprite.ready) {
+            // Drawn every frame until the sprite knows its size
+            float infinity = std::numeric_limits<float>::infinity();
+            return {-infinity, -infinity, infinity, infinity};
+        }
+        return get_object_world_bounds(get_object_data(components));
+    }
+
+    void draw_placeholder(const SDL_Rect& rect) {
+        if (placeholder_color_.a == 0) {
+            return;
+        }
+        flush_batch();
+        SDL_SetRenderDrawColor(renderer_, placeholder_color_.r,
+                               placeholder_color_.g, placeholder_color_.b,
+                               placeholder_color_.a);
+        ++render_stats_.batches;
+        SDL_RenderFillRect(renderer_, &rect);
+    }
+
+    void draw_atlas_sprite(const SpriteRendererComponent& sprite_renderer,
+                           const Image& image, const SDL_Rect& rect) {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (image.atlas_page != batch_page_ || !batch_rects_.empty()) {
+            flush_batch();
+            batch_page_ = image.atlas_page;
+        }
+        float size = static_cast<float>(AssetCache::instance().atlas().size());
+        float u_1 = image.atlas_rect.x / size;
+        float v_1 = image.atlas_rect.y / size;
+        float u_2 = (image.atlas_rect.x + image.atlas_rect.w) / size;
+        float v_2 = (image.atlas_rect.y + image.atlas_rect.h) / size;
+        if (sprite_renderer.flip_x) {
+            std::swap(u_1, u_2);
+        }
+        if (sprite_renderer.flip_y) {
+            std::swap(v_1, v_2);
+        }
+        float x_1 = static_cast<float>(rect.x);
+        float y_1 = static_cast<float>(rect.y);
+        float x_2 = static_cast<float>(rect.x + rect.w);
+        float y_2 = static_cast<float>(rect.y + rect.h);
+        SDL_Color white = {255, 255, 255, 255};
+        int first = static_cast<int>(batch_vertices_.size());
+        batch_vertices_.push_back({{x_1, y_1}, white, {u_1, v_1}});
+        batch_vertices_.push_back({{x_2, y_1}, white, {u_2, v_1}});
+        batch_vertices_.push_back({{x_2, y_2}, white, {u_2, v_2}});
+        batch_vertices_.push_back({{x_1, y_2}, white, {u_1, v_2}});
+        const int quad_indices[] = {0, 1, 2, 0, 2, 3};
+        for (int index : quad_indices) {
+            batch_indices_.push_back(first + index);
+        }
+#else
+        // No geometry rendering, sprites still share the atlas texture
+        SDL_RendererFlip flip = (SDL_RendererFlip)(
+            (sprite_renderer.flip_x ? SDL_FLIP_HORIZONTAL : 0) |
+            (sprite_renderer.flip_y ? SDL_FLIP_VERTICAL : 0));
+        ++render_stats_.batches;
+        SDL_RenderCopyEx(
+            renderer_,
+            AssetCache::instance().atlas().texture(image.atlas_page, renderer_),
+            &image.atlas_rect, &rect, 0.0, nullptr, flip);
+#endif
+    }
+
+    void flush_batch() {
+        if (!batch_rects_.empty()) {
+            SDL_SetRenderDrawColor(renderer_, batch_color_.r, batch_color_.g,
+                                   batch_color_.b, batch_color_.a);
+            ++render_stats_.batches;
+            int count = static_cast<int>(batch_rects_.size());
+            if (batch_fill_) {
+                SDL_RenderFillRects(renderer_, batch_rects_.data(), count);
+            }
+            SDL_RenderDrawRects(renderer_, batch_rects_.data(), count);
+            batch_rects_.clear();
+        }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (!batch_indices_.empty()) {
+            ++render_stats_.batches;
+            SDL_RenderGeometry(
+                renderer_,
+                AssetCache::instance().atlas().texture(batch_page_, renderer_),
+                batch_vertices_.data(),
+                static_cast<int>(batch_vertices_.size()),
+                batch_indices_.data(), static_cast<int>(batch_indices_.size()));
+            batch_vertices_.clear();
+            batch_indices_.clear();
+        }
+#endif
     }
 
     void initialize_sdl() {
@@ -363,14 +1954,26 @@ class Renderer : public ObjectManager {
                 SDL_CreateRenderer(window_, -1, get_renderer_flags(flags_));
             SDL_RenderSetLogicalSize(renderer_, LOGICAL_WINDOW_WIDTH,
                                      LOGICAL_WINDOW_HEIGHT);
+        } else if (flags_ & HEADLESS) {
+            SDL_Init(0);
+            IMG_Init(IMG_INIT_PNG);
+            surface_ = SDL_CreateRGBSurfaceWithFormat(
+                0, LOGICAL_WINDOW_WIDTH, LOGICAL_WINDOW_HEIGHT, 32,
+                SDL_PIXELFORMAT_RGBA32);
+            renderer_ = SDL_CreateSoftwareRenderer(surface_);
         }
     }
 
     void close_sdl() {
+        if (!AssetCache::is_destroyed()) {
+            AssetCache::instance().release_textures();
+        }
         SDL_DestroyRenderer(renderer_);
         SDL_DestroyWindow(window_);
+        SDL_FreeSurface(surface_);
         renderer_ = nullptr;
         window_ = nullptr;
+        surface_ = nullptr;
         IMG_Quit();
         SDL_Quit();
     }
@@ -0,0 +1,194 @@
+#ifndef VALIANT_SPATIAL_GRID_HPP
+#define VALIANT_SPATIAL_GRID_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "collider.hpp"
+
+namespace valiant {
+// Width and height of a grid cell in world units
+const float SPATIAL_GRID_CELL_SIZE = 256.0f;
+// Cell coordinates are clamped so far away bounds still map to a cell
+const float SPATIAL_GRID_MAXIMUM_CELL = 1 << 30;
+
+// Loose uniform grid of bounds keyed by id. Each id is stored in the cell
+// containing its center, so a query only has to look half a cell beyond
+// its area. Bounds larger than a cell are kept in a separate bucket that
+// every query visits. Cells are kept once created, so moving ids between
+// known cells does not allocate.
+class SpatialGrid {
+   public:
+    explicit SpatialGrid(float cell_size = SPATIAL_GRID_CELL_SIZE)
+        : cell_size_(cell_size), buckets_(1) {}
+
+    // Insert id, or move it if its bounds changed
+    void update(uint32_t id, const AABB& bounds) {
+        if (id >= slots_.size()) {
+            slots_.resize(id + 1);
+        }
+        Slot& slot = slots_[id];
+        bool large = bounds.max_x - bounds.min_x > cell_size_ ||
+                     bounds.max_y - bounds.min_y > cell_size_;
+        int32_t cell_x = large ? 0 : cell((bounds.min_x + bounds.max_x) / 2);
+        int32_t cell_y = large ? 0 : cell((bounds.min_y + bounds.max_y) / 2);
+        slot.bounds = bounds;
+        if (slot.present && slot.large == large && slot.cell_x == cell_x &&
+            slot.cell_y == cell_y) {
+            return;
+        }
+        if (slot.present) {
+            erase(id);
+        }
+        size_t bucket = 0;
+        if (!large) {
+            auto entry = cells_.find(make_key(cell_x, cell_y));
+            if (entry == cells_.end()) {
+                bucket = buckets_.size();
+                buckets_.emplace_back();
+                cells_[make_key(cell_x, cell_y)] = bucket;
+            } else {
+                bucket = entry->second;
+            }
+        }
+        slot.present = true;
+        slot.large = large;
+        slot.cell_x = cell_x;
+        slot.cell_y = cell_y;
+        slot.bucket = bucket;
+        slot.position = buckets_[bucket].size();
+        buckets_[bucket].push_back(id);
+        ++size_;
+    }
+
+    void remove(uint32_t id) {
+        if (id < slots_.size() && slots_[id].present) {
+            erase(id);
+        }
+    }
+
+    // Remove every id, keeping cells and their storage
+    void clear() {
+        for (std::vector<uint32_t>& bucket : buckets_) {
+            bucket.clear();
+        }
+        for (Slot& slot : slots_) {
+            slot.present = false;
+        }
+        size_ = 0;
+    }
+
+    // Append the ids whose bounds overlap area, in no particular order
+    void query(const AABB& area, std::vector<uint32_t>& ids) const {
+        collect(buckets_[0], area, ids);
+        // Centers of overlapping bounds are at most half a cell outside area
+        float half_cell = cell_size_ / 2;
+        int64_t min_x = cell(area.min_x - half_cell);
+        int64_t min_y = cell(area.min_y - half_cell);
+        int64_t max_x = cell(area.max_x + half_cell);
+        int64_t max_y = cell(area.max_y + half_cell);
+        if (max_x < min_x || max_y < min_y) {
+            return;
+        }
+        if ((max_x - min_x + 1) * (max_y - min_y + 1) >
+            static_cast<int64_t>(cells_.size())) {
+            // Fewer cells exist than the area covers
+            for (const auto& entry : cells_) {
+                int64_t cell_x = static_cast<int32_t>(entry.first >> 32);
+                int64_t cell_y = static_cast<int32_t>(entry.first);
+                if (cell_x >= min_x && cell_x <= max_x && cell_y >= min_y &&
+                    cell_y <= max_y) {
+                    collect(buckets_[entry.second], area, ids);
+                }
+            }
+            return;
+        }
+        for (int64_t cell_x = min_x; cell_x <= max_x; ++cell_x) {
+            for (int64_t cell_y = min_y; cell_y <= max_y; ++cell_y) {
+                auto entry = cells_.find(
+                    make_key(static_cast<int32_t>(cell_x),
+                             static_cast<int32_t>(cell_y)));
+                if (entry != cells_.end()) {
+                    collect(buckets_[entry->second], area, ids);
+                }
+            }
+        }
+    }
+
+    inline size_t size() const { return size_; }
+
+    inline float cell_size() const { return cell_size_; }
+
+   private:
+    struct Slot {
+        AABB bounds;
+        bool present;
+        bool large;
+        int32_t cell_x;
+        int32_t cell_y;
+        size_t bucket;
+        // Index of the id in its bucket
+        size_t position;
+
+        Slot()
+            : bounds(),
+              present(false),
+              large(false),
+              cell_x(0),
+              cell_y(0),
+              bucket(0),
+              position(0) {}
+    };
+
+    float cell_size_;
+    // Bucket 0 holds bounds larger than a cell
+    std::vector<std::vector<uint32_t>> buckets_;
+    std::unordered_map<uint64_t, size_t> cells_;
+    std::vector<Slot> slots_;
+    size_t size_{0};
+
+    static inline uint64_t make_key(int32_t cell_x, int32_t cell_y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) |
+               static_cast<uint32_t>(cell_y);
+    }
+
+    inline int32_t cell(float coordinate) const {
+        float index = std::floor(coordinate / cell_size_);
+        if (!(index > -SPATIAL_GRID_MAXIMUM_CELL)) {
+            return static_cast<int32_t>(-SPATIAL_GRID_MAXIMUM_CELL);
+        }
+        if (index > SPATIAL_GRID_MAXIMUM_CELL) {
+            return static_cast<int32_t>(SPATIAL_GRID_MAXIMUM_CELL);
+        }
+        return static_cast<int32_t>(index);
+    }
+
+    void collect(const std::vector<uint32_t>& bucket, const AABB& area,
+                 std::vector<uint32_t>& ids) const {
+        for (uint32_t id : bucket) {
+            const AABB& bounds = slots_[id].bounds;
+            if (bounds.min_x <= area.max_x && bounds.max_x >= area.min_x &&
+                bounds.min_y <= area.max_y && bounds.max_y >= area.min_y) {
+                ids.push_back(id);
+            }
+        }
+    }
+
+    // Swap id with the last id of its bucket and pop it
+    void erase(uint32_t id) {
+        Slot& slot = slots_[id];
+        std::vector<uint32_t>& bucket = buckets_[slot.bucket];
+        uint32_t last = bucket.back();
+        bucket[slot.position] = last;
+        slots_[last].position = slot.position;
+        bucket.pop_back();
+        slot.present = false;
+        --size_;
+    }
+};
+}  // namespace valiant
+
+#endif
@@ -6,37 +6,43 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 
+#include <memory>
 #include <string>
 
-#include "error.hpp"
+#include "asset_cache.hpp"
 
 namespace valiant {
 struct Sprite {
     std::string path;
     int width{0};
     int height{0};
-    SDL_Surface* surface;
-    SDL_Texture* texture;
+    // Shared with every sprite loaded from the same path, null until a path
+    // is assigned
+    std::shared_ptr<Image> image;
+    // Set by the renderer once the image has been uploaded. Until then the
+    // renderer draws a placeholder of width by height.
+    bool ready{false};
 
-    Sprite() : path(""), surface(nullptr), texture(nullptr) {}
+    Sprite() : path("") {}
 
     Sprite& operator=(const std::string& new_path) {
+        image = AssetCache::instance().load(new_path);
         path = new_path;
-        surface = IMG_Load(path.c_str());
-        if (!surface) {
-            // Error encountered when loading image
-            throw ValiantError(IMG_GetError());
-        }
-        width = surface->w;
-        height = surface->h;
-        // Reset texture
-        texture = nullptr;
+        width = image->width;
+        height = image->height;
+        ready = false;
         return *this;
     }
 
-    void create_texture(SDL_Renderer* renderer) {
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
+    // Decode the image on a loader thread instead of blocking. Width and
+    // height are the placeholder size until the image is ready.
+    void load_async(const std::string& new_path, int placeholder_width = 0,
+                    int placeholder_height = 0) {
+        image = AssetCache::instance().load_async(new_path);
+        path = new_path;
+        width = image->loading ? placeholder_width : image->width;
+        height = image->loading ? placeholder_height : image->height;
+        ready = false;
     }
 };
 
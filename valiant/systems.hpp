@@ -0,0 +1,235 @@
+#ifndef VALIANT_SYSTEMS_HPP
+#define VALIANT_SYSTEMS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "bounds.hpp"
+#include "collider.hpp"
+#include "object.hpp"
+#include "overlap.hpp"
+#include "registry.hpp"
+#include "shape.hpp"
+#include "sprite_renderer.hpp"
+
+namespace valiant {
+// World units per second
+struct Velocity {
+    float x;
+    float y;
+    float z;
+
+    Velocity(float new_x = 0, float new_y = 0, float new_z = 0)
+        : x(new_x), y(new_y), z(new_z) {}
+};
+
+// Move an entity by its velocity over delta seconds. Only changes the
+// transform, so it can be added as a parallel system.
+inline void move_entity(Entity, const Velocity& velocity,
+                        Transform& transform, double delta) {
+    float seconds = static_cast<float>(delta);
+    transform.position.x += velocity.x * seconds;
+    transform.position.y += velocity.y * seconds;
+    transform.position.z += velocity.z * seconds;
+}
+
+// Move every entity with a velocity and a transform by delta seconds
+inline void update_movement(Registry& registry, double delta) {
+    registry.each<Velocity, Transform>(
+        [delta](Entity entity, const Velocity& velocity, Transform& transform) {
+            move_entity(entity, velocity, transform, delta);
+        });
+}
+
+// Size of an entity as drawn, from its sprite or else its shape, the same
+// as for objects
+inline ObjectData get_entity_data(
+    ComponentPool<SpriteRendererComponent>& sprites,
+    ComponentPool<Shape>& shapes, Entity entity, const Transform& transform) {
+    return get_drawn_data(
+        transform.position,
+        sprites.contains(entity.index) ? &sprites.get(entity.index).sprite
+                                       : nullptr,
+        shapes.contains(entity.index) ? &shapes.get(entity.index) : nullptr);
+}
+
+// Overlapping pair of entities, first has the lower index
+struct EntityCollision {
+    Entity first;
+    Entity second;
+
+    bool operator==(const EntityCollision& collision) const {
+        return first == collision.first && second == collision.second;
+    }
+
+    bool operator<(const EntityCollision& collision) const {
+        return first != collision.first ? first < collision.first
+                                        : second < collision.second;
+    }
+};
+
+// Finds the overlapping pairs of entities with a transform and an enabled
+// collider component, using world bounds around their position. Like
+// CollisionManager, static colliders are kept apart so static pairs are
+// never tested, and candidates whose layers do not accept each other are
+// masked out before their bounds are compared. Bounds of each group are
+// sorted by min_x into a ColliderBuffer and tested a block at a time with
+// the overlap kernel.
+//
+// The Renderer does not run it and there are no collision callbacks for
+// entities. Call update from a system to act on the pairs.
+class CollisionSystem {
+   public:
+    // Pairs overlapping now, sorted
+    const std::vector<EntityCollision>& update(Registry& registry) {
+        dynamic_.clear();
+        static_.clear();
+        collisions_.clear();
+        ComponentPool<SpriteRendererComponent>& sprites =
+            registry.pool<SpriteRendererComponent>();
+        ComponentPool<Shape>& shapes = registry.pool<Shape>();
+        registry.each<ColliderComponent, Transform>(
+            [&](Entity entity, const ColliderComponent& collider,
+                const Transform& transform) {
+                AABB bounds = get_world_bounds(
+                    get_entity_data(sprites, shapes, entity, transform));
+                if (collider.enabled && !bounds.is_empty()) {
+                    (collider.is_static ? static_ : dynamic_)
+                        .push_back({bounds, entity, &collider});
+                }
+            });
+        sort_colliders(dynamic_, dynamic_group_);
+        sort_colliders(static_, static_group_);
+        // Largest max_x of the statics up to each one, so the statics that
+        // can reach a collider start at the first reach past its left edge
+        static_reach_.resize(static_.size());
+        float reach = -std::numeric_limits<float>::infinity();
+        for (size_t p = 0; p < static_.size(); ++p) {
+            reach = std::max(reach, static_[p].bounds.max_x);
+            static_reach_[p] = reach;
+        }
+        for (size_t i = 0; i < dynamic_.size(); ++i) {
+            const EntityCollider& collider = dynamic_[i];
+            // Colliders starting at or after this one's right edge can not
+            // overlap it
+            collide(collider, dynamic_, dynamic_group_, i + 1,
+                    end_before(dynamic_group_.sorted, i + 1, collider.bounds));
+            size_t static_begin = static_cast<size_t>(
+                std::upper_bound(static_reach_.begin(), static_reach_.end(),
+                                 collider.bounds.min_x) -
+                static_reach_.begin());
+            collide(collider, static_, static_group_, static_begin,
+                    end_before(static_group_.sorted, static_begin,
+                               collider.bounds));
+        }
+        std::sort(collisions_.begin(), collisions_.end());
+        return collisions_;
+    }
+
+    inline const std::vector<EntityCollision>& collisions() const {
+        return collisions_;
+    }
+
+   private:
+    struct EntityCollider {
+        AABB bounds;
+        Entity entity;
+        const ColliderComponent* collider;
+    };
+
+    // Bounds, layers and layer masks of colliders in sorted order
+    struct ColliderGroup {
+        ColliderBuffer sorted;
+        std::vector<uint8_t> layers;
+        std::vector<uint32_t> layer_masks;
+        // Some collider does not accept every layer
+        bool masked;
+    };
+
+    // Non-static and static colliders sorted by min_x
+    std::vector<EntityCollider> dynamic_;
+    ColliderGroup dynamic_group_;
+    std::vector<EntityCollider> static_;
+    ColliderGroup static_group_;
+    std::vector<float> static_reach_;
+    std::vector<EntityCollision> collisions_;
+
+    static void sort_colliders(std::vector<EntityCollider>& colliders,
+                               ColliderGroup& group) {
+        std::sort(colliders.begin(), colliders.end(),
+                  [](const EntityCollider& collider_1,
+                     const EntityCollider& collider_2) {
+                      return collider_1.bounds.min_x < collider_2.bounds.min_x;
+                  });
+        group.sorted.resize(colliders.size());
+        group.layers.resize(colliders.size());
+        group.layer_masks.resize(colliders.size());
+        group.masked = false;
+        for (size_t i = 0; i < colliders.size(); ++i) {
+            const ColliderComponent& collider = *colliders[i].collider;
+            group.sorted.set(i, colliders[i].bounds, true);
+            group.layers[i] = collider.layer;
+            group.layer_masks[i] = collider.layer_mask;
+            group.masked |= collider.layer_mask != ALL_COLLIDER_LAYERS;
+        }
+    }
+
+    // First collider from begin starting at or after the right edge of
+    // bounds
+    static size_t end_before(const ColliderBuffer& sorted, size_t begin,
+                             const AABB& bounds) {
+        const std::vector<float>& min_x = sorted.min_x;
+        begin = std::min(begin, min_x.size());
+        return static_cast<size_t>(std::lower_bound(min_x.begin() + begin,
+                                                    min_x.end(), bounds.max_x) -
+                                   min_x.begin());
+    }
+
+    // Add the colliders of group in [begin, end) overlapping collider.
+    // Blocks with no collider accepting its layers are not tested.
+    void collide(const EntityCollider& collider,
+                 const std::vector<EntityCollider>& targets,
+                 const ColliderGroup& group, size_t begin, size_t end) {
+        uint8_t layer = collider.collider->layer;
+        uint32_t layer_mask = collider.collider->layer_mask;
+        bool masked = group.masked || layer_mask != ALL_COLLIDER_LAYERS;
+        for (size_t start = begin; start < end; start += OVERLAP_BLOCK_SIZE) {
+            size_t count = std::min(OVERLAP_BLOCK_SIZE, end - start);
+            uint32_t accepted = 0xFFFFFFFF;
+            if (masked) {
+                accepted = 0;
+                for (size_t j = 0; j < count; ++j) {
+                    accepted |=
+                        static_cast<uint32_t>(
+                            (layer_mask >> group.layers[start + j]) & 1 &
+                            (group.layer_masks[start + j] >> layer) & 1)
+                        << j;
+                }
+                if (!accepted) {
+                    continue;
+                }
+            }
+            uint32_t mask = accepted & group.sorted.overlap_mask(
+                                           collider.bounds, start, count);
+            while (mask) {
+                const EntityCollider& target =
+                    targets[start + OverlapKernel::lowest_bit(mask)];
+                mask &= mask - 1;
+                add_collision(collider.entity, target.entity);
+            }
+        }
+    }
+
+    void add_collision(Entity entity_1, Entity entity_2) {
+        if (entity_1 < entity_2) {
+            collisions_.push_back({entity_1, entity_2});
+        } else {
+            collisions_.push_back({entity_2, entity_1});
+        }
+    }
+};
+}  // namespace valiant
+
+#endif
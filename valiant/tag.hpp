@@ -0,0 +1,91 @@
+#ifndef VALIANT_TAG_HPP
+#define VALIANT_TAG_HPP
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace valiant {
+// Name of the tag objects start with
+const char UNTAGGED[] = "untagged";
+
+// Names of every tag created, each stored once. Tags are interned with a
+// lock so objects can be tagged from any thread.
+class TagRegistry {
+   public:
+    static TagRegistry& instance() {
+        static TagRegistry tag_registry;
+        return tag_registry;
+    }
+
+    TagRegistry(const TagRegistry&) = delete;
+    TagRegistry& operator=(const TagRegistry&) = delete;
+
+    // Id of name, assigned the first time name is seen
+    uint32_t intern(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto entry = ids_.find(name);
+        if (entry != ids_.end()) {
+            return entry->second;
+        }
+        uint32_t id = static_cast<uint32_t>(names_.size());
+        names_.push_back(name);
+        ids_[name] = id;
+        return id;
+    }
+
+    // Names are never removed, so the reference stays valid
+    const std::string& name(uint32_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return names_[id];
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return names_.size();
+    }
+
+   private:
+    std::mutex mutex_;
+    // A deque keeps references to names valid as it grows
+    std::deque<std::string> names_;
+    std::unordered_map<std::string, uint32_t> ids_;
+
+    // UNTAGGED is always id 0
+    TagRegistry() {
+        names_.push_back(UNTAGGED);
+        ids_[UNTAGGED] = 0;
+    }
+};
+
+// Interned tag name. Copying and comparing tags copies and compares an
+// integer, only creating a tag from a name looks it up. Keep tags compared
+// often in a Tag instead of comparing against a string.
+class Tag {
+   public:
+    Tag() : id_(0) {}
+
+    Tag(const std::string& name) : id_(TagRegistry::instance().intern(name)) {}
+
+    Tag(const char* name) : Tag(std::string(name)) {}
+
+    inline uint32_t id() const { return id_; }
+
+    inline const std::string& name() const {
+        return TagRegistry::instance().name(id_);
+    }
+
+    inline bool operator==(const Tag& tag) const { return id_ == tag.id_; }
+
+    inline bool operator!=(const Tag& tag) const { return id_ != tag.id_; }
+
+    inline bool operator<(const Tag& tag) const { return id_ < tag.id_; }
+
+   private:
+    uint32_t id_;
+};
+}  // namespace valiant
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef VALIANT_TEXTURE_ATLAS_HPP
+#define VALIANT_TEXTURE_ATLAS_HPP
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "error.hpp"
+
+namespace valiant {
+// Width and height of every atlas page in pixels
+const int TEXTURE_ATLAS_SIZE = 2048;
+// Transparent border kept around each region so filtering does not sample
+// neighbouring sprites
+const int TEXTURE_ATLAS_PADDING = 1;
+
+struct AtlasRegion {
+    int page;
+    SDL_Rect rect;
+};
+
+struct AtlasStats {
+    // Page textures created, and regions copied into existing ones
+    size_t textures_created;
+    size_t region_uploads;
+    // Pages emptied so their space could be packed again
+    size_t pages_reset;
+};
+
+// Shelf packer. Regions are placed left to right on shelves stacked top to
+// bottom, each region going to the lowest shelf it fits on. New shelves go
+// on the first page with room left, or on a new page.
+class AtlasPacker {
+   public:
+    explicit AtlasPacker(int size = TEXTURE_ATLAS_SIZE,
+                         int padding = TEXTURE_ATLAS_PADDING)
+        : size_(size), padding_(padding) {}
+
+    // Returns false if a region of this size can never fit on a page
+    bool pack(int width, int height, AtlasRegion& region) {
+        int padded_width = width + 2 * padding_;
+        int padded_height = height + 2 * padding_;
+        if (width <= 0 || height <= 0 || padded_width > size_ ||
+            padded_height > size_) {
+            return false;
+        }
+        // Shelf with the least height left over
+        Shelf* best = nullptr;
+        for (Shelf& shelf : shelves_) {
+            if (shelf.height >= padded_height &&
+                shelf.x + padded_width <= size_ &&
+                (!best || shelf.height < best->height)) {
+                best = &shelf;
+            }
+        }
+        if (!best) {
+            int page = 0;
+            while (page < page_count() &&
+                   page_tops_[page] + padded_height > size_) {
+                ++page;
+            }
+            if (page == page_count()) {
+                page_tops_.push_back(0);
+            }
+            shelves_.push_back({page, page_tops_[page], padded_height, 0});
+            page_tops_[page] += padded_height;
+            best = &shelves_.back();
+        }
+        region.page = best->page;
+        region.rect = {best->x + padding_, best->y + padding_, width, height};
+        best->x += padded_width;
+        return true;
+    }
+
+    // Forget every region of page, its space is packed again
+    void reset_page(int page) {
+        shelves_.erase(std::remove_if(shelves_.begin(), shelves_.end(),
+                                      [page](const Shelf& shelf) {
+                                          return shelf.page == page;
+                                      }),
+                       shelves_.end());
+        page_tops_[page] = 0;
+    }
+
+    inline int page_count() const {
+        return static_cast<int>(page_tops_.size());
+    }
+
+    inline int size() const { return size_; }
+
+    inline int padding() const { return padding_; }
+
+   private:
+    struct Shelf {
+        int page;
+        int y;
+        int height;
+        int x;
+    };
+
+    std::vector<Shelf> shelves_;
+    int size_;
+    int padding_;
+    // Top of the next shelf on each page
+    std::vector<int> page_tops_;
+};
+
+// Packs image surfaces into a few large textures so that sprites sharing a
+// page can be drawn with a single call. Page surfaces are kept so images
+// loaded later can still be added. A page texture is created once, images
+// added after that only upload their own region. Pages count the regions in
+// use, a page whose regions were all removed is packed again.
+class TextureAtlas {
+   public:
+    explicit TextureAtlas(int size = TEXTURE_ATLAS_SIZE)
+        : packer_(size), stats_({0, 0, 0}) {}
+
+    ~TextureAtlas() { clear(); }
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Copy surface into the atlas. Returns false if it does not fit on a
+    // page.
+    bool add(SDL_Surface* surface, AtlasRegion& region) {
+        if (surface == nullptr ||
+            !packer_.pack(surface->w, surface->h, region)) {
+            return false;
+        }
+        while (static_cast<int>(pages_.size()) < packer_.page_count()) {
+            SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
+                0, packer_.size(), packer_.size(), 32, SDL_PIXELFORMAT_RGBA32);
+            if (!surface) {
+                throw ValiantError(SDL_GetError());
+            }
+            pages_.push_back({surface, nullptr, {}, 0});
+        }
+        Page& page = pages_[region.page];
+        // Copy pixels as they are instead of blending onto the page
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        SDL_Rect destination = region.rect;
+        SDL_BlitSurface(surface, nullptr, page.surface, &destination);
+        if (page.texture) {
+            // With the padding, which may still hold a removed region
+            int padding = packer_.padding();
+            page.dirty.push_back({region.rect.x - padding,
+                                  region.rect.y - padding,
+                                  region.rect.w + 2 * padding,
+                                  region.rect.h + 2 * padding});
+        }
+        ++page.regions;
+        return true;
+    }
+
+    // Remove a region added to page. Once a page has no regions left it is
+    // cleared and its space is reused.
+    void remove(int page_index) {
+        if (page_index < 0 || page_index >= static_cast<int>(pages_.size()) ||
+            pages_[page_index].regions == 0) {
+            return;
+        }
+        Page& page = pages_[page_index];
+        if (--page.regions > 0) {
+            return;
+        }
+        packer_.reset_page(page_index);
+        std::memset(page.surface->pixels, 0,
+                    static_cast<size_t>(page.surface->pitch) * page.surface->h);
+        // The texture keeps old pixels, regions added later upload over them
+        page.dirty.clear();
+        ++stats_.pages_reset;
+    }
+
+    // Texture of page, created on first use. Regions added since are
+    // copied into it.
+    SDL_Texture* texture(int page_index, SDL_Renderer* renderer) {
+        if (page_index < 0 || page_index >= static_cast<int>(pages_.size())) {
+            return nullptr;
+        }
+        Page& page = pages_[page_index];
+        if (!page.texture && renderer) {
+            create_texture(page, renderer);
+        }
+        for (const SDL_Rect& rect : page.dirty) {
+            upload_region(page, rect);
+        }
+        page.dirty.clear();
+        return page.texture;
+    }
+
+    inline size_t page_count() const { return pages_.size(); }
+
+    inline int size() const { return packer_.size(); }
+
+    inline AtlasStats stats() const { return stats_; }
+
+    // Remove every region, freeing pages and their textures
+    void clear() {
+        for (Page& page : pages_) {
+            SDL_DestroyTexture(page.texture);
+            SDL_FreeSurface(page.surface);
+        }
+        pages_.clear();
+        packer_ = AtlasPacker(packer_.size());
+    }
+
+   private:
+    struct Page {
+        SDL_Surface* surface;
+        SDL_Texture* texture;
+        // Regions added since the texture was created
+        std::vector<SDL_Rect> dirty;
+        // Regions added and not removed
+        size_t regions;
+    };
+
+    AtlasPacker packer_;
+    std::vector<Page> pages_;
+    AtlasStats stats_;
+
+    void create_texture(Page& page, SDL_Renderer* renderer) {
+        page.texture =
+            SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                              SDL_TEXTUREACCESS_STATIC, size(), size());
+        if (!page.texture) {
+            return;
+        }
+        SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+        SDL_UpdateTexture(page.texture, nullptr, page.surface->pixels,
+                          page.surface->pitch);
+        ++stats_.textures_created;
+    }
+
+    void upload_region(Page& page, const SDL_Rect& rect) {
+        // Pages are RGBA32, 4 bytes per pixel
+        const uint8_t* pixels =
+            static_cast<const uint8_t*>(page.surface->pixels) +
+            rect.y * page.surface->pitch + rect.x * 4;
+        SDL_UpdateTexture(page.texture, &rect, pixels, page.surface->pitch);
+        ++stats_.region_uploads;
+    }
+};
+}  // namespace valiant
+
+#endif
@@ -5,14 +5,31 @@ namespace valiant {
 class Time {
    public:
     const double &delta_time;
+    // With a fixed timestep, how far the drawn frame is past the last
+    // update, as a fraction of a step in [0, 1). Positions can be
+    // interpolated with it. Always 0 with a variable timestep.
+    const double &alpha;
 
     explicit Time(double new_delta_time = 0.)
-        : delta_time(delta_time_), delta_time_(new_delta_time) {}
+        : delta_time(delta_time_),
+          alpha(alpha_),
+          delta_time_(new_delta_time),
+          alpha_(0.) {}
+
+    // References refer to the copy's own values
+    Time(const Time &time)
+        : delta_time(delta_time_),
+          alpha(alpha_),
+          delta_time_(time.delta_time_),
+          alpha_(time.alpha_) {}
 
     void set(double new_delta_time) { delta_time_ = new_delta_time; }
 
+    void set_alpha(double new_alpha) { alpha_ = new_alpha; }
+
    private:
     double delta_time_;
+    double alpha_;
 };
 }  // namespace valiant
 
@@ -1,15 +1,25 @@
 #ifndef VALIANT_HPP
 #define VALIANT_HPP
 
+#include "asset_cache.hpp"
+#include "bounds.hpp"
 #include "camera.hpp"
 #include "collider.hpp"
 #include "color.hpp"
 #include "error.hpp"
 #include "input.hpp"
+#include "job_system.hpp"
 #include "object.hpp"
+#include "overlap.hpp"
+#include "pair_set.hpp"
+#include "registry.hpp"
 #include "renderer.hpp"
 #include "shape.hpp"
+#include "spatial_grid.hpp"
 #include "sprite_renderer.hpp"
+#include "systems.hpp"
+#include "tag.hpp"
+#include "texture_atlas.hpp"
 #include "time.hpp"
 
 #endif